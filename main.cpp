@@ -7,11 +7,80 @@
 #include <chrono>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <bit>
 #include <bitset>
 #include <functional>
 #include <filesystem>
 #include <numeric>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <semaphore>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <string_view>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AOC_X86 1
+#include <immintrin.h>
+#else
+#define AOC_X86 0
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#include <process.h>
+#define AOC_GETPID _getpid
+#else
+#include <unistd.h>
+#define AOC_GETPID getpid
+#endif
+
+// Lets single functions use AVX2 or SSSE3 without building the whole program for them. MSVC doesn't need it.
+#if defined(__GNUC__) || defined(__clang__)
+#define AOC_TARGET_AVX2 __attribute__((target("avx2")))
+#define AOC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define AOC_TARGET_AVX2
+#define AOC_TARGET_SSSE3
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Diagnostics of the day being solved on this thread. They are kept with its results, so days that run
+//	concurrently don't interleave their output, and parallel_for hands the log on to its workers.
+//	Outside of a day it is null and messages go straight to stdout.
+thread_local std::string* solver_log = nullptr;
+std::mutex solver_log_mutex;
+
+void log_line(std::string_view msg) {
+	if (solver_log == nullptr) {
+		std::cout << msg << std::endl;
+		return;
+	}
+	std::lock_guard<std::mutex> lock(solver_log_mutex);
+	solver_log->append(msg);
+	solver_log->push_back('\n');
+}
 
 bool get_data_file_name(std::string* fn_absolute, std::string fn_relative) {
 	if (fn_absolute == nullptr) {
@@ -36,120 +105,526 @@ bool get_data_file_name(std::string* fn_absolute, std::string fn_relative) {
 	return true;
 }
 
-std::vector<std::string> read_file(std::string fn) {
-	std::ifstream infile(fn);
-	std::string line;
-	std::vector<std::string> ret = {};
+// Read-only input. The file is memory mapped and the lines are views into the mapping, so the object
+//	must outlive any line taken from it. Lines are split like std::getline: on '\n', with no empty
+//	line after a trailing newline.
+class Input_file {
+public:
+	Input_file() = default;
+
+	Input_file(const Input_file&) = delete;
+	Input_file& operator=(const Input_file&) = delete;
 
-	while (std::getline(infile, line))
-	{
-		ret.push_back(line);
+	Input_file(Input_file&& other) noexcept {
+		*this = std::move(other);
 	}
 
-	return ret;
-}
+	Input_file& operator=(Input_file&& other) noexcept {
+		if (this != &other) {
+			close();
+			buf = std::exchange(other.buf, nullptr);
+			buf_size = std::exchange(other.buf_size, 0);
+			map_base = std::exchange(other.map_base, nullptr);
+			lines = std::move(other.lines);
+		}
+		return *this;
+	}
 
-void string_ltrim(std::string& s) {
-	s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
-		return !std::isspace(ch);
-		}));
-}
+	~Input_file() {
+		close();
+	}
 
-void string_rtrim(std::string& s) {
-	s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
-		return !std::isspace(ch);
-		}).base(), s.end());
-}
+	bool open(const std::string& fn) {
+		close();
+
+#ifdef _WIN32
+		HANDLE h_file = CreateFileA(fn.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (h_file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER file_size = {};
+		GetFileSizeEx(h_file, &file_size);
+		if (file_size.QuadPart > 0) {
+			HANDLE h_mapping = CreateFileMappingA(h_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (h_mapping != nullptr) {
+				map_base = MapViewOfFile(h_mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(h_mapping);
+			}
+		}
+		CloseHandle(h_file);
+		if (file_size.QuadPart > 0 && map_base == nullptr) {
+			return false;
+		}
+		buf_size = (size_t)file_size.QuadPart;
+#else
+		int fd = ::open(fn.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat st = {};
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+			return false;
+		}
+		if (st.st_size > 0) {
+			void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED) {
+				::close(fd);
+				return false;
+			}
+			madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+			map_base = p;
+		}
+		::close(fd);
+		buf_size = (size_t)st.st_size;
+#endif
 
-std::string string_trim(std::string s) {
-	string_ltrim(s);
-	string_rtrim(s);
+		buf = (const char*)map_base;
+		split_lines();
 
-	return s;
-}
+		return true;
+	}
 
-std::vector<std::string> string_split(std::string s, std::string delimiter) {
-	std::vector<std::string> ret = {};
+	std::string_view data() const { return { buf, buf_size }; }
+	size_t size() const { return lines.size(); }
+	bool empty() const { return lines.empty(); }
+	std::string_view operator[](size_t idx) const { return lines[idx]; }
+	std::vector<std::string_view>::const_iterator begin() const { return lines.begin(); }
+	std::vector<std::string_view>::const_iterator end() const { return lines.end(); }
+
+private:
+	void split_lines() {
+		lines.clear();
+		size_t offset = 0;
+		while (offset < buf_size) {
+			auto p = (const char*)std::memchr(buf + offset, '\n', buf_size - offset);
+			size_t idx_end = p == nullptr ? buf_size : (size_t)(p - buf);
+			lines.emplace_back(buf + offset, idx_end - offset);
+			offset = idx_end + 1;
+		}
+	}
 
-	size_t offset = 0;
+	void close() {
+		if (map_base != nullptr) {
+#ifdef _WIN32
+			UnmapViewOfFile(map_base);
+#else
+			munmap(map_base, buf_size);
+#endif
+		}
+		buf = nullptr;
+		buf_size = 0;
+		map_base = nullptr;
+		lines.clear();
+	}
+
+	const char* buf = nullptr;
+	size_t buf_size = 0;
+	// Set when the file is mapped
+	void* map_base = nullptr;
+	std::vector<std::string_view> lines;
+};
+
+// Reads a file in chunks of chunk_size bytes and hands them to on_chunk in order. A reader thread
+//	fills the next chunk while on_chunk processes the current one, so memory use is two chunks
+//	regardless of file size. Chunks end at arbitrary byte positions, not at line ends.
+bool stream_file(const std::string& fn, size_t chunk_size, const std::function<void(std::string_view)>& on_chunk) {
+	std::ifstream infile(fn, std::ios::binary);
+
+	if (!infile || chunk_size == 0) {
+		return false;
+	}
+
+	struct Chunk {
+		std::vector<char> buf;
+		size_t size;
+	};
+
+	Chunk chunks[2] = { { std::vector<char>(chunk_size), 0 }, { std::vector<char>(chunk_size), 0 } };
+	std::counting_semaphore<2> free_chunks(2);
+	std::counting_semaphore<2> filled_chunks(0);
+
+	std::thread reader([&]() {
+		for (size_t idx_chunk = 0; ; idx_chunk++) {
+			free_chunks.acquire();
+			auto& chunk = chunks[idx_chunk % 2];
+			infile.read(chunk.buf.data(), (std::streamsize)chunk_size);
+			chunk.size = (size_t)infile.gcount();
+			filled_chunks.release();
+			// An empty chunk tells the consumer that the file is done
+			if (chunk.size == 0) {
+				break;
+			}
+		}
+		});
 
-	while (true) {
-		size_t idx = s.find(delimiter, offset);
-		if (idx == std::string::npos) {
-			ret.push_back(s.substr(offset));
+	for (size_t idx_chunk = 0; ; idx_chunk++) {
+		filled_chunks.acquire();
+		auto& chunk = chunks[idx_chunk % 2];
+		if (chunk.size == 0) {
 			break;
 		}
-		ret.push_back(s.substr(offset, idx - offset));
-		offset = idx + delimiter.size();
+		on_chunk({ chunk.buf.data(), chunk.size });
+		free_chunks.release();
 	}
 
-	return ret;
+	reader.join();
+
+	return true;
 }
 
-std::string string_remove_char(std::string s, char c) {
-	s.erase(remove(s.begin(), s.end(), c), s.end());
+// Reassembles lines from chunks that may split them anywhere. Only the unfinished line is buffered.
+class Line_splitter {
+public:
+	template <typename Fn>
+	void feed(std::string_view chunk, Fn on_line) {
+		while (!chunk.empty()) {
+			auto idx = chunk.find('\n');
+			if (idx == std::string_view::npos) {
+				partial.append(chunk);
+				return;
+			}
+			if (partial.empty()) {
+				on_line(chunk.substr(0, idx));
+			}
+			else {
+				partial.append(chunk.substr(0, idx));
+				on_line(std::string_view(partial));
+				partial.clear();
+			}
+			chunk.remove_prefix(idx + 1);
+		}
+	}
+
+	// Emits the last line if the input didn't end with a newline
+	template <typename Fn>
+	void finish(Fn on_line) {
+		if (!partial.empty()) {
+			on_line(std::string_view(partial));
+			partial.clear();
+		}
+	}
+
+private:
+	std::string partial;
+};
+
+std::string_view string_trim(std::string_view s) {
+	auto is_space = [](unsigned char ch) { return std::isspace(ch) != 0; };
+
+	while (!s.empty() && is_space(s.front())) {
+		s.remove_prefix(1);
+	}
+	while (!s.empty() && is_space(s.back())) {
+		s.remove_suffix(1);
+	}
 
 	return s;
 }
 
-// The last element on each row is the scalar to compare with
-std::vector<double> linear_solver(std::vector<std::vector<double>> input) {
-	bool done = false;
-	size_t variables_complete = 0;
-	int steps = 0;
-
-	while (!done) {
-		// 1. Swap rows if needed
-		if (input[variables_complete][variables_complete] == 0) {
-			bool did_switch = false;
-			for (size_t i = variables_complete + 1; i < input.size(); i++) {
-				if (input[i][variables_complete] != 0) {
-					auto tmp = input[i];
-					input[i] = input[variables_complete];
-					input[variables_complete] = tmp;
-					did_switch = true;
-					break;
-				}
+// Splits a string on a delimiter without allocating. The parts are views into the input:
+//	for (auto part : String_split(line, ", ")) { ... }
+class String_split {
+public:
+	class Iterator {
+	public:
+		Iterator(std::string_view rest, std::string_view delimiter) : rest(rest), delimiter(delimiter), done(false) {
+			next();
+		}
+
+		std::string_view operator*() const { return cur; }
+
+		Iterator& operator++() {
+			next();
+			return *this;
+		}
+
+		bool operator==(std::default_sentinel_t) const { return done; }
+
+	private:
+		void next() {
+			if (rest.data() == nullptr) {
+				done = true;
+				return;
 			}
-			if (!did_switch) {
-				std::cout << "Couldn't switch. Aborting" << std::endl;
-				return {};
+			auto idx = rest.find(delimiter);
+			if (idx == std::string_view::npos) {
+				cur = rest;
+				rest = {};
+				return;
 			}
+			cur = rest.substr(0, idx);
+			rest = rest.substr(idx + delimiter.size());
+		}
+
+		std::string_view rest;
+		std::string_view delimiter;
+		std::string_view cur;
+		bool done;
+	};
+
+	String_split(std::string_view s, std::string_view delimiter) : s(s.data() == nullptr ? "" : s), delimiter(delimiter) {}
+
+	Iterator begin() const { return { s, delimiter }; }
+	std::default_sentinel_t end() const { return {}; }
+
+private:
+	std::string_view s;
+	std::string_view delimiter;
+};
+
+// Consumes a line from the front. Every operation reports whether it matched, so a fixed line
+//	format can be parsed as a chain: sc.skip("move ") && sc.read_int(&cnt) && sc.skip(" from ") ...
+struct Scanner {
+	std::string_view s;
+
+	bool skip(std::string_view literal) {
+		if (!s.starts_with(literal)) {
+			return false;
+		}
+		s.remove_prefix(literal.size());
+		return true;
+	}
+
+	template <typename T>
+	bool read_int(T* val) {
+		auto res = std::from_chars(s.data(), s.data() + s.size(), *val);
+		if (res.ec != std::errc()) {
+			return false;
+		}
+		s.remove_prefix(res.ptr - s.data());
+		return true;
+	}
+
+	bool read_char(char* c) {
+		if (s.empty()) {
+			return false;
+		}
+		*c = s.front();
+		s.remove_prefix(1);
+		return true;
+	}
+
+	std::string_view read_rest() {
+		auto ret = s;
+		s = {};
+		return ret;
+	}
+};
+
+template <typename T = int>
+T string_to_int(std::string_view s) {
+	T ret = 0;
+
+	std::from_chars(s.data(), s.data() + s.size(), ret);
+
+	return ret;
+}
+
+// Dense row-major matrix in one buffer
+template <typename T>
+struct Dense_matrix {
+	size_t num_rows;
+	size_t num_cols;
+	std::vector<T> vals;
+
+	Dense_matrix(size_t num_rows, size_t num_cols) : num_rows(num_rows), num_cols(num_cols), vals(num_rows* num_cols, T{}) {
+	}
+
+	static Dense_matrix from_rows(const std::vector<std::vector<T>>& rows) {
+		Dense_matrix ret(rows.size(), rows.empty() ? 0 : rows[0].size());
+		for (size_t r = 0; r < rows.size(); r++) {
+			std::copy(rows[r].begin(), rows[r].end(), ret.row(r));
+		}
+		return ret;
+	}
+
+	T* row(size_t r) {
+		return vals.data() + r * num_cols;
+	}
+
+	T& at(size_t r, size_t c) {
+		return vals[r * num_cols + c];
+	}
+
+	void swap_rows(size_t r1, size_t r2) {
+		if (r1 != r2) {
+			std::swap_ranges(row(r1), row(r1) + num_cols, row(r2));
 		}
-		// 2. Scale row
-		double scale_factor = input[variables_complete][variables_complete];
-		if (scale_factor != 1) {
-			for (size_t i = variables_complete; i < input[variables_complete].size(); i++) {
-				input[variables_complete][i] /= scale_factor;
+	}
+};
+
+// The last element on each row is the scalar to compare with. Solves in place using Gaussian elimination
+//	with partial pivoting. Returns an empty vector if the system is singular.
+std::vector<double> linear_solver(Dense_matrix<double>& input) {
+	size_t num_vars = input.num_rows;
+	size_t num_cols = input.num_cols;
+
+	if (num_vars == 0 || num_cols != num_vars + 1) {
+		return {};
+	}
+
+	for (size_t k = 0; k < num_vars; k++) {
+		// 1. Use the row with the largest pivot, so rows are never scaled up by a tiny pivot
+		size_t idx_pivot = k;
+		for (size_t i = k + 1; i < num_vars; i++) {
+			if (std::abs(input.at(i, k)) > std::abs(input.at(idx_pivot, k))) {
+				idx_pivot = i;
 			}
 		}
-		// 3. Multiply onto other rows
-		for (size_t idx_row = 0; idx_row < input.size(); idx_row++) {
-			if (idx_row == variables_complete) {
-				continue;
+		if (input.at(idx_pivot, k) == 0) {
+			log_line("Couldn't switch. Aborting");
+			return {};
+		}
+		input.swap_rows(k, idx_pivot);
+
+		// 2. Subtract the pivot row from the rows below. Four rows are updated per pass over the pivot
+		//	row, and the inner loops run over contiguous memory so they vectorize.
+		const double* row_k = input.row(k);
+		double pivot = row_k[k];
+		size_t i = k + 1;
+		for (; i + 4 <= num_vars; i += 4) {
+			double* rows[4] = { input.row(i), input.row(i + 1), input.row(i + 2), input.row(i + 3) };
+			double factors[4] = { rows[0][k] / pivot, rows[1][k] / pivot, rows[2][k] / pivot, rows[3][k] / pivot };
+			for (size_t j = k; j < num_cols; j++) {
+				double v = row_k[j];
+				rows[0][j] -= factors[0] * v;
+				rows[1][j] -= factors[1] * v;
+				rows[2][j] -= factors[2] * v;
+				rows[3][j] -= factors[3] * v;
 			}
-			double factor = input[idx_row][variables_complete];
+		}
+		for (; i < num_vars; i++) {
+			double* row_i = input.row(i);
+			double factor = row_i[k] / pivot;
 			if (factor != 0) {
-				for (size_t i = variables_complete; i < input[variables_complete].size(); i++) {
-					input[idx_row][i] -= factor * input[variables_complete][i];
+				for (size_t j = k; j < num_cols; j++) {
+					row_i[j] -= factor * row_k[j];
 				}
 			}
 		}
-		steps++;
-		if (++variables_complete == input.size()) {
-			done = true;
-		}
 	}
 
-	std::vector<double> ret(input.size(), 0);
+	// 3. Back substitution
+	std::vector<double> ret(num_vars, 0);
 
-	for (int i = 0; i < input.size(); i++) {
-		ret[i] = input[i][input[i].size() - 1];
+	for (size_t k = num_vars; k-- > 0;) {
+		const double* row_k = input.row(k);
+		double val = row_k[num_vars];
+		for (size_t j = k + 1; j < num_vars; j++) {
+			val -= row_k[j] * ret[j];
+		}
+		ret[k] = val / row_k[k];
 	}
 
 	return ret;
 }
 
+// Row-major grid in a single buffer. With pad > 0 the grid is surrounded by a border of pad cells
+//	on every side, so the neighbors of any inner cell can be read without bounds checks. Cells are
+//	addressed by flat index into cells; neighbors are at idx +- 1 and idx +- stride.
+template <typename T>
+struct Grid {
+	size_t num_rows;
+	size_t num_cols;
+	size_t pad;
+	size_t stride;
+	std::vector<T> cells;
+
+	Grid(size_t num_rows, size_t num_cols, size_t pad, T fill_val)
+		: num_rows(num_rows), num_cols(num_cols), pad(pad), stride(num_cols + 2 * pad), cells((num_rows + 2 * pad)* (num_cols + 2 * pad), fill_val) {
+	}
+
+	size_t idx(size_t row, size_t col) const {
+		return (row + pad) * stride + col + pad;
+	}
+
+	T& at(size_t row, size_t col) {
+		return cells[idx(row, col)];
+	}
+
+	const T& at(size_t row, size_t col) const {
+		return cells[idx(row, col)];
+	}
+
+	bool is_border(size_t idx_cell) const {
+		size_t row = idx_cell / stride;
+		size_t col = idx_cell % stride;
+		return row < pad || row >= num_rows + pad || col < pad || col >= num_cols + pad;
+	}
+};
+
+constexpr uint32_t grid_bfs_unreached = std::numeric_limits<uint32_t>::max();
+
+// Breadth-first search over the 4-neighbors of a grid, starting from all sources at once.
+//	can_move(from_val, to_val) tells whether a step is allowed. Returns the number of steps from the
+//	nearest source for every cell, indexed like grid.cells, or grid_bfs_unreached.
+template <typename T, typename Can_move>
+std::vector<uint32_t> grid_bfs(const Grid<T>& grid, const std::vector<size_t>& sources, Can_move can_move) {
+	std::vector<uint32_t> num_steps(grid.cells.size(), grid_bfs_unreached);
+	std::vector<size_t> frontier = {};
+	std::vector<size_t> next_frontier = {};
+
+	// Border cells are marked as visited, which is what makes the unchecked neighbor lookup safe
+	uint32_t border_mark = grid_bfs_unreached - 1;
+	if (grid.pad > 0) {
+		for (size_t idx_cell = 0; idx_cell < grid.cells.size(); idx_cell++) {
+			if (grid.is_border(idx_cell)) {
+				num_steps[idx_cell] = border_mark;
+			}
+		}
+	}
+
+	for (auto idx_cell : sources) {
+		if (num_steps[idx_cell] == grid_bfs_unreached) {
+			num_steps[idx_cell] = 0;
+			frontier.push_back(idx_cell);
+		}
+	}
+
+	auto stride = grid.stride;
+	auto num_cols = grid.num_cols;
+	const ptrdiff_t neighbor_offsets[] = { -1, 1, -(ptrdiff_t)stride, (ptrdiff_t)stride };
+	uint32_t cur_steps = 0;
+
+	while (!frontier.empty()) {
+		cur_steps++;
+		next_frontier.clear();
+		for (auto idx_cell : frontier) {
+			auto cur_val = grid.cells[idx_cell];
+			if (grid.pad > 0) {
+				for (auto offset : neighbor_offsets) {
+					size_t idx_neighbor = idx_cell + offset;
+					if (num_steps[idx_neighbor] == grid_bfs_unreached && can_move(cur_val, grid.cells[idx_neighbor])) {
+						num_steps[idx_neighbor] = cur_steps;
+						next_frontier.push_back(idx_neighbor);
+					}
+				}
+				continue;
+			}
+			size_t col = idx_cell % stride;
+			bool valid[] = { col > 0, col + 1 < num_cols, idx_cell >= stride, idx_cell + stride < grid.cells.size() };
+			for (int i = 0; i < 4; i++) {
+				if (!valid[i]) {
+					continue;
+				}
+				size_t idx_neighbor = idx_cell + neighbor_offsets[i];
+				if (num_steps[idx_neighbor] == grid_bfs_unreached && can_move(cur_val, grid.cells[idx_neighbor])) {
+					num_steps[idx_neighbor] = cur_steps;
+					next_frontier.push_back(idx_neighbor);
+				}
+			}
+		}
+		std::swap(frontier, next_frontier);
+	}
+
+	if (grid.pad > 0) {
+		std::replace(num_steps.begin(), num_steps.end(), border_mark, grid_bfs_unreached);
+	}
+
+	return num_steps;
+}
+
 struct Graph_node {
 	int id;
 	std::string name;
@@ -161,50 +636,30 @@ struct Node_head {
 	Node_head* last_head;
 };
 
+// Returns the path from dst back to, but not including, src. Empty if dst can't be reached.
 std::vector<Graph_node*> shortest_path(Graph_node* src, Graph_node* dst, int num_graph_nodes) {
-	std::vector<int> dist(num_graph_nodes, 0);
-	int cur_distance = 1;
-	std::vector<Graph_node*> to_search(num_graph_nodes * num_graph_nodes); // NB could be optimized when needed
-	int num_search_nodes = 0;
-	int idx_start = 0;
-	to_search[num_search_nodes++] = src;
-	int idx_end_exclusive = num_search_nodes;
-	std::vector<Graph_node*> ret = {};
-	bool done = false;
-
-	while (!done) {
-		for (int i = idx_start; i < idx_end_exclusive; i++) {
-			if (to_search[i] == dst) {
-				Graph_node* el = to_search[i];
-				while (el != src) {
-					ret.push_back(el);
-					for (auto n : el->neighbors) {
-						auto dist1 = dist[n->id];
-						auto dist2 = dist[el->id];
-						if ((n == src || dist1 != 0) && dist1 < dist2) {
-							el = n;
-							break;
-						}
-					}
-				}
-				break;
-			}
-			for (auto& n : to_search[i]->neighbors) {
-				if (n == src) {
-					continue;
-				}
-				if (dist[n->id] == 0 || dist[n->id] > cur_distance) {
-					dist[n->id] = cur_distance;
-					to_search[num_search_nodes++] = n;
-				}
+	std::vector<Graph_node*> parent(num_graph_nodes, nullptr);
+	std::vector<Graph_node*> to_search = {};
+	to_search.reserve(num_graph_nodes);
+	to_search.push_back(src);
+	parent[src->id] = src;
+
+	// Each node is queued at most once, since it's marked when queued
+	for (size_t i = 0; i < to_search.size() && parent[dst->id] == nullptr; i++) {
+		for (auto n : to_search[i]->neighbors) {
+			if (parent[n->id] == nullptr) {
+				parent[n->id] = to_search[i];
+				to_search.push_back(n);
 			}
 		}
-		idx_start = idx_end_exclusive;
-		idx_end_exclusive = num_search_nodes;
-		cur_distance++;
-		if (idx_end_exclusive == idx_start) {
-			done = true;
-		}
+	}
+
+	std::vector<Graph_node*> ret = {};
+	if (parent[dst->id] == nullptr) {
+		return ret;
+	}
+	for (Graph_node* el = dst; el != src; el = parent[el->id]) {
+		ret.push_back(el);
 	}
 
 	return ret;
@@ -212,27 +667,16 @@ std::vector<Graph_node*> shortest_path(Graph_node* src, Graph_node* dst, int num
 
 std::vector<Graph_node*> connected_nodes(std::vector<Graph_node>& all_nodes, Graph_node* src, int num_graph_nodes) {
 	std::vector<bool> visited(num_graph_nodes, false);
-	std::vector<Graph_node*> to_search(num_graph_nodes * num_graph_nodes); // NB could be optimized when needed
-	int num_search_nodes = 0;
-	int idx_start = 0;
-	to_search[num_search_nodes++] = src;
-	int idx_end_exclusive = num_search_nodes;
-	bool done = false;
-
-	while (!done) {
-		for (int i = idx_start; i < idx_end_exclusive; i++) {
-			visited[to_search[i]->id] = true;
-			for (auto& n : to_search[i]->neighbors) {
-				if (!visited[n->id]) {
-					to_search[num_search_nodes++] = n;
-				}
+	std::vector<Graph_node*> to_search = { src };
+	visited[src->id] = true;
+
+	for (size_t i = 0; i < to_search.size(); i++) {
+		for (auto n : to_search[i]->neighbors) {
+			if (!visited[n->id]) {
+				visited[n->id] = true;
+				to_search.push_back(n);
 			}
 		}
-		idx_start = idx_end_exclusive;
-		idx_end_exclusive = num_search_nodes;
-		if (idx_end_exclusive == idx_start) {
-			done = true;
-		}
 	}
 
 	std::vector<Graph_node*> ret = {};
@@ -245,1106 +689,3464 @@ std::vector<Graph_node*> connected_nodes(std::vector<Graph_node>& all_nodes, Gra
 	return ret;
 }
 
-std::string replace_all(std::string s, std::string to_replace, std::string replace_with) {
-	auto pos = s.find(to_replace, 0);
-	while (pos != std::string::npos) {
-		s.replace(pos, to_replace.size(), replace_with);
-		pos = s.find(to_replace, 0);
-	}
-
-	return s;
-}
+// Graph in compressed sparse row form, for graphs too large for Graph_node. The neighbors of node n
+//	are targets[offsets[n]] up to, but not including, targets[offsets[n + 1]].
+struct Csr_graph {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> targets;
 
-long long gcd(long long a, long long b) {
-	while (b != 0) {
-		long long m = a % b;
-		a = b;
-		b = m;
+	size_t num_nodes() const {
+		return offsets.empty() ? 0 : offsets.size() - 1;
 	}
+};
 
-	return a;
-}
+struct Graph_edge {
+	uint32_t from;
+	uint32_t to;
+};
 
-long long lcm(long long a, long long b) {
-	return b * (a / gcd(a, b));
-}
+constexpr uint32_t graph_no_node = std::numeric_limits<uint32_t>::max();
 
-long long lcm(std::vector<long long> vals) {
-	long long ret = 0;
+// Edges are directed; add both directions for an undirected graph
+Csr_graph csr_from_edges(size_t num_nodes, const std::vector<Graph_edge>& edges) {
+	Csr_graph graph = { std::vector<uint32_t>(num_nodes + 1, 0), std::vector<uint32_t>(edges.size()) };
 
-	if (vals.size() == 0) {
-		return 0;
+	for (auto& edge : edges) {
+		graph.offsets[edge.from + 1]++;
+	}
+	for (size_t i = 0; i < num_nodes; i++) {
+		graph.offsets[i + 1] += graph.offsets[i];
 	}
 
-	ret = vals[0];
+	std::vector<uint32_t> fill_pos(graph.offsets.begin(), graph.offsets.end() - 1);
+	for (auto& edge : edges) {
+		graph.targets[fill_pos[edge.from]++] = edge.to;
+	}
 
-	for (int i = 1; i < vals.size(); i++) {
-		ret = lcm(ret, vals[i]);
+	return graph;
+}
+
+// Node ids must be 0..all_nodes.size() - 1
+Csr_graph csr_from_nodes(const std::vector<Graph_node>& all_nodes) {
+	std::vector<Graph_edge> edges = {};
+
+	for (auto& node : all_nodes) {
+		for (auto n : node.neighbors) {
+			edges.push_back({ (uint32_t)node.id, (uint32_t)n->id });
+		}
 	}
 
-	return ret;
+	return csr_from_edges(all_nodes.size(), edges);
 }
 
-struct Task_result {
-	long long pt1;
-	long long pt2;
-	// Most answers are numbers. Appently, some are strings. If string is set, it overrides int.
-	std::string pt1_string;
-	std::string pt2_string;
+struct Graph_bfs_result {
+	// Number of steps from src, or graph_no_node if not reached
+	std::vector<uint32_t> dist;
+	// Previous node on a shortest path from src, or graph_no_node
+	std::vector<uint32_t> parent;
 };
 
-void aoc01(std::vector<std::string> lines, Task_result* result) {
-	auto calc = [&lines](size_t num_top_vals) {
-		int elf_id = 0;
-		int num_cals = 0;
-		std::vector<int> top_vals(num_top_vals, 0);
-		size_t idx_min_top_val = 0;
-
-		for (auto& line : lines) {
-			if (line.empty()) {
-				if (num_cals > top_vals[idx_min_top_val]) {
-					top_vals[idx_min_top_val] = num_cals;
-					int cur_min = std::numeric_limits<int>::max();
-					for (size_t i = 0; i < num_top_vals; i++) {
-						if (top_vals[i] < cur_min) {
-							idx_min_top_val = i;
-							cur_min = top_vals[i];
-						}
-					}
-				}
-				elf_id++;
-				num_cals = 0;
-			}
-			else {
-				num_cals += std::atoi(line.c_str());
-			}
-		}
+// Stops as soon as dst is reached. Pass graph_no_node as dst to search the whole graph.
+Graph_bfs_result graph_bfs(const Csr_graph& graph, uint32_t src, uint32_t dst = graph_no_node) {
+	auto num_nodes = graph.num_nodes();
+	Graph_bfs_result ret = { std::vector<uint32_t>(num_nodes, graph_no_node), std::vector<uint32_t>(num_nodes, graph_no_node) };
+	std::vector<uint32_t> to_search = {};
+	to_search.reserve(num_nodes);
 
-		int sum_top_vals = 0;
-		for (auto& v : top_vals) {
-			sum_top_vals += v;
-		}
-		return sum_top_vals;
-		};
+	to_search.push_back(src);
+	ret.dist[src] = 0;
 
-	result->pt1 = calc(1);
-	result->pt2 = calc(3);
+	for (size_t i = 0; i < to_search.size(); i++) {
+		auto cur = to_search[i];
+		if (cur == dst) {
+			break;
+		}
+		for (auto idx = graph.offsets[cur]; idx < graph.offsets[cur + 1]; idx++) {
+			auto n = graph.targets[idx];
+			if (ret.dist[n] == graph_no_node) {
+				ret.dist[n] = ret.dist[cur] + 1;
+				ret.parent[n] = cur;
+				to_search.push_back(n);
+			}
+		}
+	}
 
+	return ret;
 }
 
-void aoc02(std::vector<std::string> lines, Task_result* result) {
-	struct Outcomes {
-		char first;
-		char second;
-		int val;
-	};
+// Nodes from src to dst, both included. Empty if dst can't be reached.
+std::vector<uint32_t> graph_shortest_path(const Csr_graph& graph, uint32_t src, uint32_t dst) {
+	auto bfs = graph_bfs(graph, src, dst);
+	std::vector<uint32_t> ret = {};
 
-	std::vector<Outcomes> outcomes = {
-		{'A','X',3},
-		{'A','Y',6},
-		{'A','Z',0},
-		{'B','X',0},
-		{'B','Y',3},
-		{'B','Z',6},
-		{'C','X',6},
-		{'C','Y',0},
-		{'C','Z',3},
-	};
+	if (bfs.dist[dst] == graph_no_node) {
+		return ret;
+	}
+	for (auto n = dst; n != graph_no_node; n = bfs.parent[n]) {
+		ret.push_back(n);
+	}
+	std::reverse(ret.begin(), ret.end());
 
-	int total_score = 0;
-	for (auto& line : lines) {
-		char cf = line[0];
-		char cs = line[2];
-		int score = cs - 'X' + 1;
-		for (int i = 0; i < outcomes.size(); i++) {
-			auto& outcome = outcomes[i];
-			if (outcome.first == cf && outcome.second == cs) {
-				score += outcome.val;
-				break;
+	return ret;
+}
+
+// Component id for every node, numbered from 0 in order of their lowest node. Edges are followed in
+//	their stored direction, so the graph should hold both directions of every edge.
+std::vector<uint32_t> graph_components(const Csr_graph& graph, uint32_t* num_components) {
+	auto num_nodes = graph.num_nodes();
+	std::vector<uint32_t> component(num_nodes, graph_no_node);
+	std::vector<uint32_t> to_search = {};
+	to_search.reserve(num_nodes);
+	uint32_t cur_component = 0;
+
+	for (uint32_t start = 0; start < num_nodes; start++) {
+		if (component[start] != graph_no_node) {
+			continue;
+		}
+		to_search.clear();
+		to_search.push_back(start);
+		component[start] = cur_component;
+		for (size_t i = 0; i < to_search.size(); i++) {
+			auto cur = to_search[i];
+			for (auto idx = graph.offsets[cur]; idx < graph.offsets[cur + 1]; idx++) {
+				auto n = graph.targets[idx];
+				if (component[n] == graph_no_node) {
+					component[n] = cur_component;
+					to_search.push_back(n);
+				}
 			}
 		}
-		total_score += score;
+		cur_component++;
 	}
 
-	result->pt1 = total_score;
+	if (num_components != nullptr) {
+		*num_components = cur_component;
+	}
 
-	std::map<char, int> lose_scores = {
-		{'A', 3},
-		{'B', 1},
-		{'C', 2}
-	};
+	return component;
+}
 
-	std::map<char, int> draw_scores = {
-		{'A', 1},
-		{'B', 2},
-		{'C', 3}
-	};
+long long gcd(long long a, long long b) {
+	while (b != 0) {
+		long long m = a % b;
+		a = b;
+		b = m;
+	}
 
-	std::map<char, int> win_scores = {
-		{'A', 2},
-		{'B', 3},
-		{'C', 1}
-	};
+	return a;
+}
 
-	std::map<char, std::map<char, int>> map_outcome = {
-		{'X',lose_scores},
-		{'Y',draw_scores},
-		{'Z',win_scores}
-	};
+// Multiplication that reports overflow instead of wrapping
+bool checked_mul(long long a, long long b, long long* out) {
+#if defined(__GNUC__) || defined(__clang__)
+	return !__builtin_mul_overflow(a, b, out);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	long long high = 0;
+	*out = _mul128(a, b, &high);
+	return high == (*out < 0 ? -1 : 0);
+#else
+	if (a != 0 && ((a == -1 && b == std::numeric_limits<long long>::min()) || (b == -1 && a == std::numeric_limits<long long>::min())
+		|| std::abs(b) > std::numeric_limits<long long>::max() / std::abs(a))) {
+		return false;
+	}
+	*out = a * b;
+	return true;
+#endif
+}
 
-	total_score = 0;
-	for (auto& line : lines) {
-		char cf = line[0];
-		char cs = line[2];
-		switch (cs) {
-		case 'X': total_score += 0 + lose_scores[cf]; break;
-		case 'Y': total_score += 3 + draw_scores[cf]; break;
-		case 'Z': total_score += 6 + win_scores[cf]; break;
+// Decimal string of a * b for products that don't fit in 64 bits. Schoolbook multiplication in base 10^9.
+std::string mul_to_string(unsigned long long a, unsigned long long b) {
+	const unsigned long long base = 1000000000;
+	unsigned long long a_limbs[3] = { a % base, a / base % base, a / base / base };
+	unsigned long long b_limbs[3] = { b % base, b / base % base, b / base / base };
+	unsigned long long limbs[6] = {};
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			limbs[i + j] += a_limbs[i] * b_limbs[j];
+			limbs[i + j + 1] += limbs[i + j] / base;
+			limbs[i + j] %= base;
 		}
 	}
-	result->pt2 = total_score;
-}
 
-void aoc03(std::vector<std::string> lines, Task_result* result) {
-	int prio_sum = 0;
+	int idx_top = 5;
+	while (idx_top > 0 && limbs[idx_top] == 0) {
+		idx_top--;
+	}
+	std::string ret = std::to_string(limbs[idx_top]);
+	for (int i = idx_top - 1; i >= 0; i--) {
+		auto limb = std::to_string(limbs[i]);
+		ret += std::string(9 - limb.size(), '0') + limb;
+	}
 
-	auto compartment_to_binary = [](std::string s) {
-		unsigned long long val = {};
-		for (char c : s) {
-			if (c >= 'a') {
-				c -= 'a';
-				c += 1;
-			}
-			else {
-				c -= 'A';
-				c += 27;
-			}
-			val |= (1ull << (unsigned long long)c);
-		}
-		return val;
-		};
+	return ret;
+}
 
-	for (auto& line : lines) {
-		unsigned long long vals[2] = {};
-		vals[0] = compartment_to_binary(line.substr(0, line.size() / 2));
-		vals[1] = compartment_to_binary(line.substr(line.size() / 2));
-		auto res = vals[0] & vals[1];
-		auto prio = std::countr_zero(res);
-		prio_sum += prio;
-	}
-	result->pt1 = prio_sum;
-
-	prio_sum = 0;
-	for (int idx_group = 0; idx_group < lines.size() / 3; idx_group++) {
-		unsigned long long vals[3] = {};
-		int group_size = 3;
-		for (int i = 0; i < group_size; i++) {
-			vals[i] = compartment_to_binary(lines[idx_group * group_size + i]);
-		}
-		auto res = vals[0] & vals[1] & vals[2];
-		auto prio = std::countr_zero(res);
-		prio_sum += prio;
+bool checked_add(long long a, long long b, long long* out) {
+#if defined(__GNUC__) || defined(__clang__)
+	return !__builtin_add_overflow(a, b, out);
+#else
+	if ((b > 0 && a > std::numeric_limits<long long>::max() - b) || (b < 0 && a < std::numeric_limits<long long>::min() - b)) {
+		return false;
 	}
-	result->pt2 = prio_sum;
+	*out = a + b;
+	return true;
+#endif
 }
 
-void aoc04(std::vector<std::string> lines, Task_result* result) {
-	struct Range {
-		int start;
-		int end_incl;
-	};
-
-	int num_contained = 0;
-	int num_overlap = 0;
-	for (auto& line : lines) {
-		auto elve_ranges = string_split(line, ",");
-		std::vector<std::string> range_string[2] = {
-			string_split(elve_ranges[0], "-"),
-			string_split(elve_ranges[1], "-")
-		};
-		std::vector<Range> ranges(2);
-		ranges[0].start = std::atoi(range_string[0][0].c_str());
-		ranges[0].end_incl = std::atoi(range_string[0][1].c_str());
-		ranges[1].start = std::atoi(range_string[1][0].c_str());
-		ranges[1].end_incl = std::atoi(range_string[1][1].c_str());
-		bool is_contained = false;
-		bool has_overlap = false;
-		for (int i = 0; i < 2; i++) {
-			auto r1 = i == 0 ? ranges[0] : ranges[1];
-			auto r2 = i == 0 ? ranges[1] : ranges[0];
-			if (r1.start <= r2.start && r1.end_incl >= r2.end_incl) {
-				is_contained = true;
-			}
-			if (r1.start <= r2.end_incl && r1.end_incl >= r2.start) {
-				has_overlap = true;
-			}
-		}
-		if (is_contained) {
-			num_contained++;
-		}
-		if (has_overlap) {
-			num_overlap++;
-		}
+bool checked_sub(long long a, long long b, long long* out) {
+#if defined(__GNUC__) || defined(__clang__)
+	return !__builtin_sub_overflow(a, b, out);
+#else
+	if ((b < 0 && a > std::numeric_limits<long long>::max() + b) || (b > 0 && a < std::numeric_limits<long long>::min() + b)) {
+		return false;
 	}
-	result->pt1 = num_contained;
-	result->pt2 = num_overlap;
+	*out = a - b;
+	return true;
+#endif
 }
 
-void aoc05(std::vector<std::string> lines, Task_result* result) {
-	auto num_stacks = (lines[0].size() + 1) / 4;
-	std::vector<std::vector<char>> stacks_orig(num_stacks, std::vector<char>());
+// The lcm functions return false if the lcm doesn't fit in 64 bits
+bool lcm(long long a, long long b, long long* out) {
+	return checked_mul(b, a / gcd(a, b), out);
+}
 
-	size_t num_lines = 0;
+// 0 for no values
+bool lcm(const std::vector<long long>& vals, long long* out) {
+	long long ret = 0;
 
-	for (auto& line : lines) {
-		if (line.empty()) {
-			num_lines--;
-			break;
+	if (vals.size() == 0) {
+		*out = 0;
+		return true;
+	}
+
+	ret = vals[0];
+
+	for (size_t i = 1; i < vals.size(); i++) {
+		if (!lcm(ret, vals[i], &ret)) {
+			return false;
 		}
-		num_lines++;
 	}
 
-	for (int idx_container = (int)num_lines - 1; idx_container >= 0; idx_container--) {
-		for (int idx_stack = 0; idx_stack < num_stacks; idx_stack++) {
-			auto cc = lines[idx_container][4 * idx_stack + 1];
-			if (cc != ' ') {
-				stacks_orig[idx_stack].push_back(cc);
-			}
+	*out = ret;
+	return true;
+}
+
+// (a * b) % mod without overflow, for 0 <= a, b < mod
+long long mul_mod(long long a, long long b, long long mod) {
+	unsigned long long ua = (unsigned long long)a;
+	unsigned long long ub = (unsigned long long)b;
+	unsigned long long umod = (unsigned long long)mod;
+	if (((ua | ub) >> 32) == 0) {
+		return (long long)(ua * ub % umod);
+	}
+#if defined(__SIZEOF_INT128__)
+	return (long long)((unsigned __int128)ua * ub % umod);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long long high = 0;
+	unsigned long long low = _umul128(ua, ub, &high);
+	unsigned long long rem = 0;
+	_udiv128(high, low, umod, &rem);
+	return (long long)rem;
+#else
+	// Double and add. Both terms are below mod < 2^63, so their sum can't wrap.
+	unsigned long long ret = 0;
+	while (ub != 0) {
+		if (ub & 1) {
+			ret += ua;
+			ret -= ret >= umod ? umod : 0;
 		}
+		ua += ua;
+		ua -= ua >= umod ? umod : 0;
+		ub >>= 1;
 	}
+	return (long long)ret;
+#endif
+}
 
-	struct Move {
-		int cnt;
-		int idx_from;
-		int idx_to;
-	};
+struct Rational {
+	long long num;
+	long long den;
+};
 
-	auto idx_move_start = num_lines + 2;
+// Exact solver for integer systems. The last element on each row is the scalar to compare with.
+//	Uses fraction-free (Bareiss) Gauss-Jordan elimination: every division is exact, so all
+//	intermediate values stay integers, bounded by determinants of the input. Solves in place.
+//	Returns false if the system is singular or an intermediate value overflows.
+bool linear_solver_exact(Dense_matrix<long long>& input, std::vector<Rational>* solution) {
+	size_t num_vars = input.num_rows;
+	size_t num_cols = input.num_cols;
+
+	if (num_vars == 0 || num_cols != num_vars + 1) {
+		return false;
+	}
 
-	auto num_moves = lines.size() - idx_move_start;
-	std::vector<Move> moves(num_moves);
+	long long prev_pivot = 1;
 
-	for (int idx_move = 0; idx_move < num_moves; idx_move++) {
-		auto line = lines[idx_move_start + idx_move];
-		line = replace_all(line, "move ", "");
-		line = replace_all(line, "from ", "");
-		line = replace_all(line, "to ", "");
-		auto line_parts = string_split(line, " ");
-		moves[idx_move] = { std::atoi(line_parts[0].c_str()), std::atoi(line_parts[1].c_str()) - 1, std::atoi(line_parts[2].c_str()) - 1 };
-	}
-
-	for (int idx_pt = 1; idx_pt <= 2; idx_pt++) {
-		auto stacks = stacks_orig;
-		for (auto& move : moves) {
-			auto num_el_from = stacks[move.idx_from].size();
-			for (int i = 0; i < move.cnt; i++) {
-				char el = {};
-				if (idx_pt == 1) {
-					el = stacks[move.idx_from][num_el_from - 1 - i];
+	for (size_t k = 0; k < num_vars; k++) {
+		size_t idx_pivot = k;
+		while (idx_pivot < num_vars && input.at(idx_pivot, k) == 0) {
+			idx_pivot++;
+		}
+		if (idx_pivot == num_vars) {
+			log_line("Couldn't switch. Aborting");
+			return false;
+		}
+		input.swap_rows(k, idx_pivot);
+
+		const long long* row_k = input.row(k);
+		long long pivot = row_k[k];
+		for (size_t i = 0; i < num_vars; i++) {
+			if (i == k) {
+				continue;
+			}
+			long long* row_i = input.row(i);
+			long long factor = row_i[k];
+			for (size_t j = 0; j < num_cols; j++) {
+				if (j == k) {
+					continue;
 				}
-				if (idx_pt == 2) {
-					el = stacks[move.idx_from][num_el_from - move.cnt + i];
+				long long a = 0;
+				long long b = 0;
+				long long diff = 0;
+				if (!checked_mul(row_i[j], pivot, &a) || !checked_mul(factor, row_k[j], &b) || !checked_sub(a, b, &diff)) {
+					log_line("Overflow in exact linear solver");
+					return false;
 				}
-				stacks[move.idx_to].push_back(el);
+				row_i[j] = diff / prev_pivot;
 			}
-			for (int i = 0; i < move.cnt; i++) {
-				stacks[move.idx_from].pop_back();
-			}
-		}
-
-		std::string pt = {};
-		for (auto& stack : stacks) {
-			pt += stack.back();
+			row_i[k] = 0;
 		}
+		prev_pivot = pivot;
+	}
 
-		if (idx_pt == 1) {
-			result->pt1_string = pt;
-		}
-		if (idx_pt == 2) {
-			result->pt2_string = pt;
+	// All diagonal elements are now the determinant
+	solution->assign(num_vars, { 0, 1 });
+	for (size_t i = 0; i < num_vars; i++) {
+		long long num = input.at(i, num_vars);
+		long long den = input.at(i, i);
+		if (den < 0) {
+			num = -num;
+			den = -den;
 		}
+		long long div = std::abs(gcd(num, den));
+		(*solution)[i] = { num / div, den / div };
 	}
-}
-
-void aoc06(std::vector<std::string> lines, Task_result* result) {
-	auto calc = [](std::string line, int num_chars_in_row) {
-		auto line_size = line.size();
 
-		std::vector<bool> possible_pos(line.size(), true);
-		std::vector<int> last_char_pos('z' + 1, -1);
+	return true;
+}
 
-		for (int idx_char = 0; idx_char < line_size; idx_char++) {
-			auto cur_char = line[idx_char];
-			auto last_pos = last_char_pos[cur_char];
-			if (last_pos > -1 && (idx_char - last_pos < num_chars_in_row)) {
-				for (int i = idx_char - num_chars_in_row + 1; i <= last_pos; i++) {
-					if (i < 0) {
-						continue;
-					}
-					possible_pos[i] = false;
-				}
-			}
-			last_char_pos[cur_char] = idx_char;
-		}
+// Threads the current thread may keep busy, itself included. 0 means one per core. main sets it from
+//	--threads, and parallel_for hands each of its workers an equal share.
+thread_local size_t thread_budget = 0;
 
-		int ret = 0;
+size_t get_thread_budget() {
+	return thread_budget != 0 ? thread_budget : std::max(1u, std::thread::hardware_concurrency());
+}
 
-		for (int i = 0; i < possible_pos.size(); i++) {
-			if (possible_pos[i] == true) {
-				ret = i + num_chars_in_row;
-				break;
-			}
+// Runs fn(idx) for every idx in [0, num_tasks) on a pool of worker threads. Workers pick the next task
+//	as soon as they are done with the previous one. num_threads = 0 means the whole thread budget.
+//	A parallel_for inside fn splits its worker's share of the budget, so nesting doesn't oversubscribe.
+template <typename Fn>
+void parallel_for(size_t num_tasks, Fn fn, size_t num_threads = 0) {
+	size_t budget = get_thread_budget();
+	if (num_threads == 0) {
+		num_threads = budget;
+	}
+	num_threads = std::max<size_t>(1, std::min(num_threads, num_tasks));
+	size_t worker_budget = std::max<size_t>(1, budget / num_threads);
+
+	std::atomic<size_t> idx_next_task = 0;
+	auto caller_log = solver_log;
+	auto worker = [&]() {
+		size_t prev_budget = thread_budget;
+		auto prev_log = solver_log;
+		thread_budget = worker_budget;
+		solver_log = caller_log;
+		for (size_t idx_task = idx_next_task++; idx_task < num_tasks; idx_task = idx_next_task++) {
+			fn(idx_task);
 		}
-
-		return ret;
+		thread_budget = prev_budget;
+		solver_log = prev_log;
 		};
 
-	for (int i = 0; i < lines.size(); i++) {
-		result->pt1_string += (i == 0 ? "" : ",") + std::to_string(calc(lines[i], 4));
-		result->pt2_string += (i == 0 ? "" : ",") + std::to_string(calc(lines[i], 14));
+	std::vector<std::thread> threads = {};
+	for (size_t i = 1; i < num_threads; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& t : threads) {
+		t.join();
 	}
 }
 
-void aoc07(std::vector<std::string> lines, Task_result* result) {
-	struct Dir_file {
-		std::string name;
-		int fsize;
-	};
-	struct Dir_folder {
-		std::string name;
-		Dir_folder* parent;
-		int level;
-		int tot_size;
-		std::vector<Dir_folder> folders;
-		std::vector<Dir_file> files;
-	};
-	struct Command {
-		std::string cmd;
-		std::vector<std::string> output;
-	};
-
-	Dir_folder root_folder = { "/", nullptr, 0 };
-	Dir_folder* cur_folder = &root_folder;
-	std::vector<Command> commands = {};
+// Calls fn(line) for every line of buf, split like Input_file: a final newline doesn't start another line
+template <typename Fn>
+void for_each_line(std::string_view buf, Fn fn) {
+	size_t offset = 0;
+	while (offset < buf.size()) {
+		auto p = (const char*)std::memchr(buf.data() + offset, '\n', buf.size() - offset);
+		size_t idx_end = p == nullptr ? buf.size() : (size_t)(p - buf.data());
+		fn(buf.substr(offset, idx_end - offset));
+		offset = idx_end + 1;
+	}
+}
 
-	for (auto& line : lines) {
-		if (!line.empty() && line[0] == '$') {
-			commands.push_back({ line.substr(2),{} });
+// Folds the lines of buf into a State (add_line), one chunk per budgeted thread, and merges the chunk states in
+//	order (merge). A State that has add_lines(chunk) gets whole chunks instead. Chunks start at a line
+//	whose index is a multiple of group_size, for folds over groups of lines. A State with
+//	split_at_blank_lines gets chunks that start right after a blank line instead, for groups of varying
+//	size. Inputs smaller than two chunks of min_chunk_size are folded on the calling thread.
+template <typename State>
+State parallel_reduce_lines(std::string_view buf, size_t group_size = 1, size_t min_chunk_size = 1 << 20) {
+	auto fold = [](State* state, std::string_view chunk) {
+		if constexpr (requires { state->add_lines(chunk); }) {
+			state->add_lines(chunk);
 		}
-		if (!line.empty() && line[0] != '$') {
-			commands.back().output.push_back(line);
+		else {
+			for_each_line(chunk, [state](std::string_view line) { state->add_line(line); });
 		}
+	};
+
+	size_t num_chunks = std::clamp<size_t>(buf.size() / min_chunk_size, 1, get_thread_budget());
+	if (num_chunks == 1) {
+		State state = {};
+		fold(&state, buf);
+		return state;
 	}
 
-	for (auto& cmd : commands) {
-		auto cmd_parts = string_split(cmd.cmd, " ");
-		if (cmd_parts.size() == 0) {
-			continue;
+	// Move a position forward to the start of the next line, or of the line after num_lines more newlines
+	auto skip_lines = [buf](size_t pos, size_t num_lines) {
+		for (size_t i = 0; i < num_lines && pos < buf.size(); i++) {
+			auto p = (const char*)std::memchr(buf.data() + pos, '\n', buf.size() - pos);
+			pos = p == nullptr ? buf.size() : (size_t)(p - buf.data()) + 1;
 		}
-		if (cmd_parts[0] == "cd") {
-			if (cmd_parts[1] == "/") {
-				cur_folder = &root_folder;
-			}
-			if (cmd_parts[1] == "..") {
-				cur_folder = cur_folder->parent;
-			}
-			if (cmd_parts[1] != "/" && cmd_parts[1] != "..") {
-				bool found = false;
-				for (auto& f : cur_folder->folders) {
-					if (f.name == cmd_parts[1]) {
-						cur_folder = &f;
-						found = true;
-						break;
-					}
-				}
-				if (!found) {
-					std::cout << std::format("Could not find folder {} in folder {}", cmd_parts[1], cur_folder->name) << std::endl;
-					return;
-				}
+		return pos;
+	};
+
+	std::vector<size_t> chunk_starts(num_chunks + 1, buf.size());
+	chunk_starts[0] = 0;
+	for (size_t idx_chunk = 1; idx_chunk < num_chunks; idx_chunk++) {
+		size_t pos = std::max(chunk_starts[idx_chunk - 1], idx_chunk * buf.size() / num_chunks);
+		chunk_starts[idx_chunk] = pos == 0 || buf[pos - 1] == '\n' ? pos : skip_lines(pos, 1);
+		if constexpr (requires { State::split_at_blank_lines; }) {
+			size_t pos_line = chunk_starts[idx_chunk];
+			if (pos_line > 1 && pos_line < buf.size()) {
+				size_t idx_blank = buf.find("\n\n", pos_line - 2);
+				chunk_starts[idx_chunk] = idx_blank == std::string_view::npos ? buf.size() : idx_blank + 2;
 			}
 		}
-		if (cmd_parts[0] == "ls") {
-			for (auto& o : cmd.output) {
-				auto o_parts = string_split(o, " ");
-				if (o_parts.empty()) {
-					continue;
-				}
-				if (o_parts[0] == "dir") {
-					cur_folder->folders.push_back({ o_parts[1], cur_folder, cur_folder->level + 1 });
-				}
-				if (o_parts[0] != "dir") {
-					cur_folder->files.push_back({ o_parts[1], std::atoi(o_parts[0].c_str()) });
-				}
-			}
+	}
+
+	if (group_size > 1) {
+		std::vector<size_t> num_lines(num_chunks, 0);
+		parallel_for(num_chunks, [&](size_t idx_chunk) {
+			num_lines[idx_chunk] = std::count(buf.begin() + chunk_starts[idx_chunk], buf.begin() + chunk_starts[idx_chunk + 1], '\n');
+			});
+		size_t num_lines_before = 0;
+		std::vector<size_t> aligned_starts = chunk_starts;
+		for (size_t idx_chunk = 1; idx_chunk < num_chunks; idx_chunk++) {
+			num_lines_before += num_lines[idx_chunk - 1];
+			size_t num_skipped = (group_size - num_lines_before % group_size) % group_size;
+			aligned_starts[idx_chunk] = std::max(aligned_starts[idx_chunk - 1], skip_lines(chunk_starts[idx_chunk], num_skipped));
 		}
+		chunk_starts = aligned_starts;
 	}
 
-	std::vector<Dir_folder*> folders = { &root_folder };
-	int idx_start = 0;
-	int idx_end_exclusive = (int)folders.size();
+	std::vector<State> states(num_chunks);
+	parallel_for(num_chunks, [&](size_t idx_chunk) {
+		fold(&states[idx_chunk], buf.substr(chunk_starts[idx_chunk], chunk_starts[idx_chunk + 1] - chunk_starts[idx_chunk]));
+		});
 
-	while (idx_start != idx_end_exclusive) {
-		int cnt_new_folders = 0;
-		for (int i = idx_start; i < idx_end_exclusive; i++) {
-			auto f = folders[i];
-			for (auto& child : f->folders) {
-				folders.push_back(&child);
-				cnt_new_folders++;
-			}
-		}
-		idx_start = idx_end_exclusive;
-		idx_end_exclusive += cnt_new_folders;
+	for (size_t idx_chunk = 1; idx_chunk < num_chunks; idx_chunk++) {
+		states[0].merge(states[idx_chunk]);
 	}
 
-	size_t max_level = 0;
-	for (auto f : folders) {
-		if (f->level > max_level) {
-			max_level = f->level;
+	return std::move(states[0]);
+}
+
+// Set of visited 2D cells. Starts as a bitmap over the bounding box of the cells seen so far, which
+//	grows by doubling. When the box becomes much larger than the number of visited cells, or larger
+//	than max_bitmap_bits, the set switches to an open addressing hash of packed coordinates and stays
+//	there. Cells that don't fit the 32 bit halves of a packed key go to a small ordered set instead.
+//	Long spans are kept as intervals in either mode, merged with each other as the lists grow and with the
+//	cells only when size() is called.
+class Visited_set {
+public:
+	void insert(long long x, long long y) {
+		if (is_bitmap) {
+			if (!in_box(x, y)) {
+				grow(x, y, 1);
+			}
+			if (is_bitmap) {
+				set_bit(x, y);
+				return;
+			}
 		}
+		hash_insert(x, y);
 	}
 
-	for (int cur_level = (int)max_level; cur_level >= 0; cur_level--) {
-		for (auto& f : folders) {
-			if (f->level == cur_level) {
-				for (auto& child_folder : f->folders) {
-					f->tot_size += child_folder.tot_size;
-				}
-				for (auto& cur_file : f->files) {
-					f->tot_size += cur_file.fsize;
-				}
+	// Inserts the len cells (x, y), (x + x_delta, y + y_delta), ... A long horizontal or vertical span
+	//	is one interval, a short horizontal span in the bitmap is filled a word at a time.
+	void insert_span(long long x, long long y, int x_delta, int y_delta, long long len) {
+		if (len <= 0) {
+			return;
+		}
+		long long end_x = x + x_delta * (len - 1);
+		long long end_y = y + y_delta * (len - 1);
+		if (len >= min_interval_len && (x_delta == 0) != (y_delta == 0)) {
+			auto& intervals = y_delta == 0 ? row_intervals : col_intervals;
+			auto& num_merged = y_delta == 0 ? num_row_intervals_merged : num_col_intervals_merged;
+			long long fixed = y_delta == 0 ? y : x;
+			long long start = y_delta == 0 ? x : y;
+			long long end = y_delta == 0 ? end_x : end_y;
+			intervals.push_back({ fixed, std::min(start, end), std::max(start, end) });
+			// Merging whenever the list doubles keeps it within twice the distinct spans, at amortized O(log n)
+			if (intervals.size() >= 2 * std::max<size_t>(num_merged, min_intervals_to_merge)) {
+				merge_intervals(intervals);
+				num_merged = intervals.size();
 			}
+			return;
 		}
-	}
 
-	size_t max_size = 100'000;
-	int tot_disk_space = 70'000'000;
-	int required_disk_space = 30'000'000;
-	int cur_disk_space = tot_disk_space - folders[0]->tot_size;
-	int min_delete_folder_size = required_disk_space - cur_disk_space;
-	int cur_smallest_size = std::numeric_limits<int>::max();
+		if (is_bitmap && !in_box(x, y)) {
+			grow(x, y, len);
+		}
+		if (is_bitmap && !in_box(end_x, end_y)) {
+			grow(end_x, end_y, len);
+		}
 
-	for (auto f : folders) {
-		if (f->tot_size < max_size) {
-			result->pt1 += f->tot_size;
+		if (is_bitmap && y_delta == 0) {
+			set_row_bits(y, std::min<long long>(x, end_x), std::max<long long>(x, end_x));
+			return;
 		}
-		if (f->tot_size >= min_delete_folder_size && f->tot_size < cur_smallest_size) {
-			cur_smallest_size = f->tot_size;
-			result->pt2 = cur_smallest_size;
+		for (long long idx = 0; idx < len; idx++) {
+			long long cell_x = x + x_delta * idx;
+			long long cell_y = y + y_delta * idx;
+			if (is_bitmap) {
+				set_bit(cell_x, cell_y);
+			}
+			else {
+				hash_insert(cell_x, cell_y);
+			}
 		}
 	}
-}
 
-void aoc08(std::vector<std::string> lines, Task_result* result) {
-	if (lines.empty() || lines[0].empty()) {
-		return;
+	size_t size() const {
+		if (row_intervals.empty() && col_intervals.empty()) {
+			return count;
+		}
+		return size_with_intervals();
 	}
 
-	struct Tree {
-		int height;
-		int scenic_score;
-	};
+private:
+	// Cells fixed, lo..hi of a row or column, both ends included
+	struct Interval {
+		long long fixed;
+		long long lo;
+		long long hi;
 
-	int num_rows = (int)lines.size();
-	int num_cols = (int)lines[0].size();
-	std::vector<std::vector<Tree>> trees(num_rows, std::vector<Tree>(num_cols, { 0,0 }));
+		bool operator<(const Interval& other) const {
+			return fixed != other.fixed ? fixed < other.fixed : lo < other.lo;
+		}
+	};
 
-	for (int row = 0; row < num_rows; row++) {
-		for (int col = 0; col < num_cols; col++) {
-			trees[row][col] = { lines[row][col] - '0', 0 };
+	static constexpr long long min_interval_len = 64;
+	static constexpr size_t min_intervals_to_merge = 64;
+	std::vector<Interval> row_intervals = {};
+	std::vector<Interval> col_intervals = {};
+	// Sizes of the interval lists after they were last merged
+	size_t num_row_intervals_merged = 0;
+	size_t num_col_intervals_merged = 0;
+
+	// Sorts and joins overlapping or touching intervals on the same row or column, in place
+	static void merge_intervals(std::vector<Interval>& intervals) {
+		std::sort(intervals.begin(), intervals.end());
+		size_t num_merged = 0;
+		for (auto& interval : intervals) {
+			if (num_merged > 0 && intervals[num_merged - 1].fixed == interval.fixed && interval.lo <= intervals[num_merged - 1].hi + 1) {
+				intervals[num_merged - 1].hi = std::max(intervals[num_merged - 1].hi, interval.hi);
+			}
+			else {
+				intervals[num_merged++] = interval;
+			}
 		}
+		intervals.resize(num_merged);
 	}
 
-	int idx_tree = 0;
-	int delta_rows[] = { 1,-1,0,0 };
-	int delta_cols[] = { 0,0,1,-1 };
-	int max_step = num_rows;
-
-	if (num_cols > num_rows) {
-		max_step = num_cols;
+	static bool intervals_contain(const std::vector<Interval>& merged, long long fixed, long long pos) {
+		auto it = std::upper_bound(merged.begin(), merged.end(), Interval{ fixed, pos, pos });
+		return it != merged.begin() && std::prev(it)->fixed == fixed && std::prev(it)->hi >= pos;
 	}
 
-	int num_free_sight = 0;
-	for (int row = 0; row < num_rows; row++) {
-		for (int col = 0; col < num_cols; col++) {
-			bool free_sight = false;
-			int cur_height = trees[row][col].height;
-			int sight_length[4] = {};
-			for (int i = 0; i < 4; i++) {
-				auto delta_row = delta_rows[i];
-				auto delta_col = delta_cols[i];
-				for (int step = 1; step < max_step; step++) {
-					auto cur_row = row + delta_row * step;
-					auto cur_col = col + delta_col * step;
-					if (cur_row < 0 || cur_row >= num_rows) {
-						free_sight = true;
-						break;
-					}
-					if (cur_col < 0 || cur_col >= num_cols) {
-						free_sight = true;
-						break;
-					}
-					sight_length[i] = step;
-					if (trees[cur_row][cur_col].height >= cur_height) {
-						break;
-					}
-				}
+	// |rows| + |cols| - |rows and cols crossings| + cells outside all intervals. The crossings are
+	//	counted with a sweep over x and a Fenwick tree over the rows that are open at x.
+	size_t size_with_intervals() const {
+		auto rows = row_intervals;
+		auto cols = col_intervals;
+		merge_intervals(rows);
+		merge_intervals(cols);
+		long long num_cells = 0;
+		for (auto& interval : rows) {
+			num_cells += interval.hi - interval.lo + 1;
+		}
+		for (auto& interval : cols) {
+			num_cells += interval.hi - interval.lo + 1;
+		}
+
+		std::vector<long long> ys = {};
+		for (auto& row : rows) {
+			ys.push_back(row.fixed);
+		}
+		ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+		auto y_rank = [&ys](long long y) { return (size_t)(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin()); };
+
+		// Event kinds sort so rows open and close before columns at the same x are counted
+		struct Event {
+			long long x;
+			int kind;
+			size_t idx;
+		};
+		std::vector<Event> events = {};
+		for (size_t idx = 0; idx < rows.size(); idx++) {
+			events.push_back({ rows[idx].lo, 0, idx });
+			events.push_back({ rows[idx].hi + 1, 1, idx });
+		}
+		for (size_t idx = 0; idx < cols.size(); idx++) {
+			events.push_back({ cols[idx].fixed, 2, idx });
+		}
+		std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+			return a.x != b.x ? a.x < b.x : a.kind < b.kind;
+			});
+
+		std::vector<long long> tree(ys.size() + 1, 0);
+		auto tree_add = [&tree](size_t idx, long long val) {
+			for (idx++; idx < tree.size(); idx += idx & (~idx + 1)) {
+				tree[idx] += val;
 			}
-			int scenic_score = 1;
-			for (int i = 0; i < 4; i++) {
-				scenic_score *= sight_length[i];
+		};
+		auto tree_sum = [&tree](size_t end) {
+			long long sum = 0;
+			for (; end > 0; end -= end & (~end + 1)) {
+				sum += tree[end];
+			}
+			return sum;
+		};
+		for (auto& event : events) {
+			if (event.kind == 2) {
+				auto& col = cols[event.idx];
+				num_cells -= tree_sum(y_rank(col.hi + 1)) - tree_sum(y_rank(col.lo));
 			}
-			trees[row][col].scenic_score = scenic_score;
-			idx_tree++;
-			if (free_sight) {
-				num_free_sight++;
+			else {
+				tree_add(y_rank(rows[event.idx].fixed), event.kind == 0 ? 1 : -1);
 			}
 		}
-	}
-
-	result->pt1 = num_free_sight;
 
-	int max_scenic_score = 0;
-	for (int row = 0; row < num_rows; row++) {
-		for (int col = 0; col < num_cols; col++) {
-			auto& tree = trees[row][col];
-			if (tree.scenic_score > max_scenic_score) {
-				max_scenic_score = tree.scenic_score;
+		auto add_cell = [&](long long x, long long y) {
+			num_cells += !intervals_contain(rows, y, x) && !intervals_contain(cols, x, y);
+		};
+		if (is_bitmap) {
+			for_each_run([&](long long x_lo, long long x_hi, long long y) {
+				for (long long x = x_lo; x <= x_hi; x++) {
+					add_cell(x, y);
+				}
+				});
+		}
+		for (auto key : slots) {
+			if (key != empty_key) {
+				add_cell((int32_t)(key >> 32), (int32_t)(uint32_t)key);
 			}
 		}
+		if (has_empty_key) {
+			add_cell(-1, -1);
+		}
+		for (auto& [x, y] : far_cells) {
+			add_cell(x, y);
+		}
+
+		return (size_t)num_cells;
 	}
 
-	result->pt2 = max_scenic_score;
-}
+	// Box bitmap, one row of num_words_per_row words per y. It may be sparse up to max_dense_bits,
+	//	and is never more than max_bitmap_bits (16 MiB).
+	static constexpr long long max_dense_bits = 1ll << 22;
+	static constexpr long long max_bitmap_bits = 1ll << 27;
+	bool is_bitmap = true;
+	long long min_x = 0;
+	long long min_y = 0;
+	long long num_words_per_row = 0;
+	long long num_rows = 0;
+	std::vector<uint64_t> bits = {};
+	size_t count = 0;
+
+	// Hash mode. The packed key of (-1, -1) doubles as the empty slot marker, so it is tracked apart.
+	static constexpr uint64_t empty_key = ~0ull;
+	std::vector<uint64_t> slots = {};
+	bool has_empty_key = false;
+	std::set<std::pair<long long, long long>> far_cells = {};
+
+	static bool fits_key(long long x, long long y) {
+		return x >= INT32_MIN && x <= INT32_MAX && y >= INT32_MIN && y <= INT32_MAX;
+	}
 
-void aoc09(std::vector<std::string> lines, Task_result* result) {
-	enum class Dir { Up, Down, Left, Right };
+	static uint64_t pack(long long x, long long y) {
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+	}
 
-	struct Move {
-		Dir dir;
-		int cnt;
-	};
+	static uint64_t hash(uint64_t key) {
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33;
+		return key;
+	}
 
-	struct Pos {
-		int x;
-		int y;
-	};
+	bool in_box(long long x, long long y) const {
+		return x >= min_x && x < min_x + num_words_per_row * 64 && y >= min_y && y < min_y + num_rows;
+	}
 
-	auto step_dist = [](int x1, int y1, int x2, int y2) {
-		return std::max(std::abs(x1 - x2), std::abs(y1 - y2));
-		};
+	void set_bit(long long x, long long y) {
+		size_t idx_bit = (size_t)(x - min_x);
+		auto& word = bits[(size_t)(y - min_y) * num_words_per_row + idx_bit / 64];
+		uint64_t bit = 1ull << (idx_bit % 64);
+		count += (word & bit) == 0;
+		word |= bit;
+	}
 
-	std::vector<Move> moves = {};
+	// Cells x_lo..x_hi of row y, both included
+	void set_row_bits(long long y, long long x_lo, long long x_hi) {
+		uint64_t* row = &bits[(size_t)(y - min_y) * num_words_per_row];
+		size_t idx_lo = (size_t)(x_lo - min_x);
+		size_t idx_hi = (size_t)(x_hi - min_x);
+		for (size_t idx_word = idx_lo / 64; idx_word <= idx_hi / 64; idx_word++) {
+			uint64_t mask = ~0ull;
+			if (idx_word == idx_lo / 64) {
+				mask &= ~0ull << (idx_lo % 64);
+			}
+			if (idx_word == idx_hi / 64) {
+				mask &= ~0ull >> (63 - idx_hi % 64);
+			}
+			count += std::popcount(mask & ~row[idx_word]);
+			row[idx_word] |= mask;
+		}
+	}
 
-	for (auto& line : lines) {
-		auto pts = string_split(line, " ");
-		if (pts.size() != 2) {
-			std::cout << "Could not parse line: " << line << std::endl;
-			continue;
+	void hash_insert(long long x, long long y) {
+		if (!fits_key(x, y)) {
+			count += far_cells.insert({ x, y }).second;
+			return;
 		}
-		Dir dir = {};
-		switch (pts[0][0]) {
-		case 'U': dir = Dir::Up; break;
-		case 'D': dir = Dir::Down; break;
-		case 'L': dir = Dir::Left; break;
-		case 'R': dir = Dir::Right; break;
+		uint64_t key = pack(x, y);
+		if (key == empty_key) {
+			count += !has_empty_key;
+			has_empty_key = true;
+			return;
+		}
+		if ((count + 1) * 2 > slots.size()) {
+			rehash(std::max<size_t>(slots.size() * 2, 1024));
+		}
+		size_t mask = slots.size() - 1;
+		for (size_t idx = hash(key) & mask; ; idx = (idx + 1) & mask) {
+			if (slots[idx] == key) {
+				return;
+			}
+			if (slots[idx] == empty_key) {
+				slots[idx] = key;
+				count++;
+				return;
+			}
 		}
-
-		moves.push_back({ dir,std::atoi(pts[1].c_str()) });
 	}
 
-	auto simulate = [&moves, &step_dist](int num_knots) -> int {
-		std::vector<Pos> positions(num_knots, { {} });
-		std::vector<Pos> covered_tail_positions = { positions.back() };
-
-		for (auto& move : moves) {
-			int x_delta = 0;
-			int y_delta = 0;
-			switch (move.dir) {
-			case Dir::Up: y_delta = -1; break;
-			case Dir::Down: y_delta = 1; break;
-			case Dir::Left: x_delta = -1; break;
-			case Dir::Right: x_delta = 1; break;
+	void rehash(size_t num_slots) {
+		std::vector<uint64_t> old_slots(num_slots, empty_key);
+		std::swap(slots, old_slots);
+		size_t mask = num_slots - 1;
+		for (auto key : old_slots) {
+			if (key == empty_key) {
+				continue;
 			}
-			for (int idx_move = 0; idx_move < move.cnt; idx_move++) {
-				for (int idx_knot = 0; idx_knot < num_knots; idx_knot++) {
-					if (idx_knot == 0) {
-						positions[0].x += x_delta;
-						positions[0].y += y_delta;
+			size_t idx = hash(key) & mask;
+			while (slots[idx] != empty_key) {
+				idx = (idx + 1) & mask;
+			}
+			slots[idx] = key;
+		}
+	}
+
+	// Calls fn(x_lo, x_hi, y) for every run of set cells in a bitmap row, both ends included
+	template <typename Fn>
+	void for_each_run(Fn fn) const {
+		for (long long row = 0; row < num_rows; row++) {
+			long long run_start = -1;
+			for (long long idx_word = 0; idx_word < num_words_per_row; idx_word++) {
+				uint64_t word = bits[row * num_words_per_row + idx_word];
+				int idx_bit = 0;
+				while (idx_bit < 64) {
+					// Look for the next set bit outside a run and the next clear bit inside one
+					uint64_t rest = (run_start < 0 ? word : ~word) >> idx_bit;
+					if (rest == 0) {
+						break;
+					}
+					idx_bit += std::countr_zero(rest);
+					if (run_start < 0) {
+						run_start = idx_word * 64 + idx_bit;
 					}
-					if (idx_knot > 0) {
-						auto& pos_prev = positions[idx_knot - 1];
-						auto& pos_cur = positions[idx_knot];
-						if (step_dist(pos_prev.x, pos_prev.y, pos_cur.x, pos_cur.y) > 1) {
-							if (pos_prev.x != pos_cur.x) {
-								int diff = pos_prev.x - pos_cur.x;
-								pos_cur.x += diff / std::abs(diff);
-							}
-							if (pos_prev.y != pos_cur.y) {
-								int diff = pos_prev.y - pos_cur.y;
-								pos_cur.y += diff / std::abs(diff);
-							}
-							if (idx_knot == num_knots - 1) {
-								covered_tail_positions.push_back(pos_cur);
-							}
-						}
+					else {
+						fn(min_x + run_start, min_x + idx_word * 64 + idx_bit - 1, min_y + row);
+						run_start = -1;
 					}
 				}
 			}
+			if (run_start >= 0) {
+				fn(min_x + run_start, min_x + num_words_per_row * 64 - 1, min_y + row);
+			}
 		}
+	}
 
-		std::set<int> pos_unique = {};
-
-		for (auto& p : covered_tail_positions) {
-			pos_unique.insert(p.x * 10000 + p.y);
+	// num_new_cells is how many cells are about to be inserted, so one long span doesn't count as sparse
+	void grow(long long x, long long y, long long num_new_cells) {
+		long long new_min_x = x;
+		long long new_max_x = x;
+		long long new_min_y = y;
+		long long new_max_y = y;
+		if (num_rows > 0) {
+			// Double the box on each side that has to grow, so a walk in one direction grows it log times
+			long long width = num_words_per_row * 64;
+			long long max_x = min_x + width - 1;
+			long long max_y = min_y + num_rows - 1;
+			new_min_x = x < min_x ? std::min(x, min_x - width) : min_x;
+			new_max_x = x > max_x ? std::max(x, max_x + width) : max_x;
+			new_min_y = y < min_y ? std::min(y, min_y - num_rows) : min_y;
+			new_max_y = y > max_y ? std::max(y, max_y + num_rows) : max_y;
 		}
 
-		return (int)pos_unique.size();
-		};
-
+		long long new_num_words_per_row = (new_max_x - new_min_x) / 64 + 1;
+		long long new_num_rows = new_max_y - new_min_y + 1;
+		// Far apart cells would overflow the bit count, and are sparse anyway
+		bool is_huge = new_num_words_per_row > max_dense_bits || new_num_rows > max_dense_bits;
+		long long num_bits = is_huge ? std::numeric_limits<long long>::max() : new_num_words_per_row * 64 * new_num_rows;
+
+		if (num_bits > max_bitmap_bits || (num_bits > max_dense_bits && num_bits > 64 * ((long long)count + num_new_cells))) {
+			is_bitmap = false;
+			count = 0;
+			rehash(1024);
+			for_each_run([this](long long x_lo, long long x_hi, long long cell_y) {
+				if (x_hi - x_lo + 1 >= min_interval_len) {
+					row_intervals.push_back({ cell_y, x_lo, x_hi });
+					return;
+				}
+				for (long long cell_x = x_lo; cell_x <= x_hi; cell_x++) {
+					hash_insert(cell_x, cell_y);
+				}
+				});
+			bits = {};
+			return;
+		}
 
-	result->pt1 = simulate(2);
-	result->pt2 = simulate(10);
-}
+		std::vector<uint64_t> new_bits((size_t)num_bits / 64, 0);
+		std::swap(bits, new_bits);
+		Visited_set old = {};
+		old.min_x = min_x;
+		old.min_y = min_y;
+		old.num_words_per_row = num_words_per_row;
+		old.num_rows = num_rows;
+		old.bits = std::move(new_bits);
+
+		min_x = new_min_x;
+		min_y = new_min_y;
+		num_words_per_row = new_num_words_per_row;
+		num_rows = new_num_rows;
+		count = 0;
+		old.for_each_run([this](long long x_lo, long long x_hi, long long cell_y) { set_row_bits(cell_y, x_lo, x_hi); });
+	}
+};
 
-void aoc10(std::vector<std::string> lines, Task_result* result) {
-	enum class Instruction_type { Noop, Addx };
+// Sequences as treaps keyed by position, all nodes in one arena. Splitting off or appending a run of any
+//	length is O(log n), and a run is reversed in O(1) by flipping a flag that is pushed down lazily.
+//	A tree is referred to by the index of its root; null_node is the empty tree.
+template <typename T>
+class Implicit_treap {
+public:
+	static constexpr uint32_t null_node = 0;
 
-	struct Instruction {
-		Instruction_type type;
-		int val;
-	};
+	Implicit_treap() : nodes(1, Node{ T{}, 0, 0, null_node, null_node, false }) {
+	}
 
-	std::map<Instruction_type, int> instruction_cycles = {
-		{Instruction_type::Noop, 1},
-		{Instruction_type::Addx, 2}
-	};
+	uint32_t size(uint32_t tree) const {
+		return nodes[tree].size;
+	}
 
-	std::vector<Instruction> instructions = {};
+	uint32_t push_back(uint32_t tree, T val) {
+		nodes.push_back({ val, next_priority(), 1, null_node, null_node, false });
+		return merge(tree, (uint32_t)nodes.size() - 1);
+	}
 
-	for (auto& line : lines) {
-		auto pts = string_split(line, " ");
-		if (pts.size() == 0) {
-			continue;
+	uint32_t merge(uint32_t left, uint32_t right) {
+		if (left == null_node) {
+			return right;
 		}
-		Instruction instruction = {};
-
-		if (pts[0] == "noop") {
-			instruction.type = Instruction_type::Noop;
+		if (right == null_node) {
+			return left;
 		}
-		if (pts.size() == 2 && pts[0] == "addx") {
-			instruction.type = Instruction_type::Addx;
-			instruction.val = std::atoi(pts[1].c_str());
+		if (nodes[left].priority > nodes[right].priority) {
+			push_down(left);
+			nodes[left].right = merge(nodes[left].right, right);
+			update(left);
+			return left;
 		}
+		push_down(right);
+		nodes[right].left = merge(left, nodes[right].left);
+		update(right);
+		return right;
+	}
 
-		instructions.push_back(instruction);
+	// The first cnt elements go to left, the rest to right
+	void split(uint32_t tree, uint32_t cnt, uint32_t* left, uint32_t* right) {
+		if (tree == null_node) {
+			*left = null_node;
+			*right = null_node;
+			return;
+		}
+		push_down(tree);
+		uint32_t size_left = nodes[nodes[tree].left].size;
+		if (cnt <= size_left) {
+			uint32_t tree_left = nodes[tree].left;
+			split(tree_left, cnt, left, &tree_left);
+			nodes[tree].left = tree_left;
+			*right = tree;
+		}
+		else {
+			uint32_t tree_right = nodes[tree].right;
+			split(tree_right, cnt - size_left - 1, &tree_right, right);
+			nodes[tree].right = tree_right;
+			*left = tree;
+		}
+		update(tree);
 	}
 
-	int idx_instruction = 0;
-	auto cur_instruction = instructions[idx_instruction];
-	int cycles_left = instruction_cycles[cur_instruction.type];
-	std::vector<int> measure_cycles = { 20,60,100,140,180,220 };
-	int reg_x = 1;
-	int num_cycles = 240;
-	std::vector<int> x_per_cycle(num_cycles);
-	int num_instructions = (int)instructions.size();
+	void reverse(uint32_t tree) {
+		if (tree != null_node) {
+			nodes[tree].is_reversed = !nodes[tree].is_reversed;
+		}
+	}
 
-	for (int idx_cycle = 1; idx_cycle <= num_cycles; idx_cycle++) {
-		x_per_cycle[idx_cycle - 1] = reg_x;
-		cycles_left--;
-		if (cycles_left == 0) {
-			if (cur_instruction.type == Instruction_type::Addx) {
-				reg_x += cur_instruction.val;
-			}
-			idx_instruction++;
-			if (idx_instruction >= num_instructions) {
-				cur_instruction.type = Instruction_type::Noop;
-			}
-			else {
-				cur_instruction = instructions[idx_instruction];
-				cycles_left = instruction_cycles[cur_instruction.type];
+	// Last element, following pending reversals on the way down. tree must not be empty.
+	T back(uint32_t tree) const {
+		bool is_reversed = false;
+		while (true) {
+			is_reversed ^= nodes[tree].is_reversed;
+			uint32_t last = is_reversed ? nodes[tree].left : nodes[tree].right;
+			if (last == null_node) {
+				return nodes[tree].val;
 			}
+			tree = last;
 		}
 	}
 
-	int res = 0;
-	for (auto& measure_cycle : measure_cycles) {
-		res += measure_cycle * x_per_cycle[measure_cycle - 1];
+private:
+	struct Node {
+		T val;
+		uint32_t priority;
+		uint32_t size;
+		uint32_t left;
+		uint32_t right;
+		bool is_reversed;
+	};
+
+	std::vector<Node> nodes;
+	uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+	uint32_t next_priority() {
+		rng_state ^= rng_state << 13;
+		rng_state ^= rng_state >> 7;
+		rng_state ^= rng_state << 17;
+		return (uint32_t)(rng_state >> 32);
+	}
+
+	void push_down(uint32_t tree) {
+		auto& node = nodes[tree];
+		if (!node.is_reversed) {
+			return;
+		}
+		std::swap(node.left, node.right);
+		reverse(node.left);
+		reverse(node.right);
+		node.is_reversed = false;
 	}
 
-	result->pt1 = res;
-	result->pt2_string = "RKAZAJBR";	// Extracted from print loop below
+	void update(uint32_t tree) {
+		nodes[tree].size = nodes[nodes[tree].left].size + nodes[nodes[tree].right].size + 1;
+	}
+};
 
-	//for (int idx_cycle = 0; idx_cycle < num_cycles; idx_cycle++) {
-	//	int row_len = 40;
-	//	int row = idx_cycle / row_len;
-	//	int col = idx_cycle % row_len;
-	//	char c = '.';
-	//	if (std::abs(x_per_cycle[idx_cycle] - col) <= 1) {
-	//		c = '#';
-	//	}
-	//	std::cout << c;
-	//	if ((idx_cycle + 1) % row_len == 0) {
-	//		std::cout << std::endl;
-	//	}
-	//}
+// SIMD paths check this at runtime, so the program still runs on CPUs without AVX2
+bool cpu_has_avx2() {
+#if AOC_X86 && (defined(__GNUC__) || defined(__clang__))
+	static const bool has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+#elif AOC_X86 && defined(_MSC_VER)
+	static const bool has_avx2 = []() {
+		int info[4] = {};
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+		// The OS must also save the AVX registers
+		__cpuid(info, 1);
+		bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+		}();
+	return has_avx2;
+#else
+	return false;
+#endif
 }
 
-void aoc11(std::vector<std::string> lines, Task_result* result) {
-	struct Monkey {
-		int id;
-		std::vector<long long> items;
-		std::function<long long(long long)> operation;
-		long long test_divisor;
+bool cpu_has_ssse3() {
+#if AOC_X86 && (defined(__GNUC__) || defined(__clang__))
+	static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+	return has_ssse3;
+#elif AOC_X86 && defined(_MSC_VER)
+	static const bool has_ssse3 = []() {
+		int info[4] = {};
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+		}();
+	return has_ssse3;
+#else
+	return false;
+#endif
+}
+
+using Bench_clock = std::chrono::steady_clock;
+
+struct Task_result {
+	long long pt1;
+	long long pt2;
+	// Most answers are numbers. Appently, some are strings. If string is set, it overrides int.
+	std::string pt1_string;
+	std::string pt2_string;
+	// Diagnostics written while solving, printed before the answers
+	std::string log;
+	// Set by a solver that could not compute an answer. The run then fails.
+	bool failed;
+	// Phase boundaries set by the solvers, used when benchmarking. A solver that doesn't set one
+	//	fuses those phases, and the benchmark reports no rows for them, only solve and total.
+	Bench_clock::time_point t_parsed;
+	Bench_clock::time_point t_pt1;
+};
+
+// Days 1-4, 6, 9 and 10 are single-pass folds over the lines. Their state structs are shared by the
+//	regular solvers and the streaming solvers (see stream_fns()).
+// The K largest values seen so far, in descending order. Also answers any smaller k from the same pass.
+template <size_t K>
+struct Top_k {
+	std::array<long long, K> vals = {};
+	size_t num_vals = 0;
+
+	void add(long long val) {
+		if (num_vals == K && val <= vals[K - 1]) {
+			return;
+		}
+		size_t idx = num_vals < K ? num_vals++ : K - 1;
+		while (idx > 0 && vals[idx - 1] < val) {
+			vals[idx] = vals[idx - 1];
+			idx--;
+		}
+		vals[idx] = val;
+	}
+
+	void merge(const Top_k& other) {
+		for (size_t i = 0; i < other.num_vals; i++) {
+			add(other.vals[i]);
+		}
+	}
+
+	// Sum of the k largest values, k <= K
+	long long sum(size_t k) const {
+		long long ret = 0;
+		for (size_t i = 0; i < std::min(k, num_vals); i++) {
+			ret += vals[i];
+		}
+		return ret;
+	}
+};
+
+struct Aoc01_state {
+	static constexpr bool split_at_blank_lines = true;
+
+	Top_k<3> top_cals = {};
+	long long num_cals = 0;
+
+	void add_line(std::string_view line) {
+		if (line.empty()) {
+			top_cals.add(num_cals);
+			num_cals = 0;
+		}
+		else {
+			num_cals += string_to_int<long long>(line);
+		}
+	}
+
+	// other must start right after a blank line, so no elf is split between the two
+	void merge(const Aoc01_state& other) {
+		top_cals.merge(other.top_cals);
+		num_cals = other.num_cals;
+	}
+
+	void finish(Task_result* result) {
+		result->pt1 = top_cals.sum(1);
+		result->pt2 = top_cals.sum(3);
+	}
+};
+
+void aoc01(const Input_file& lines, Task_result* result) {
+	auto state = parallel_reduce_lines<Aoc01_state>(lines.data());
+	state.finish(result);
+}
+
+// Scores of a round, indexed by (opponent - 'A') * 4 + (second column - 'X'). Part 1 reads the second
+//	column as our shape, part 2 as the outcome (lose, draw, win). 16 entries so the table fits one
+//	SIMD register for byte shuffles; the entries with index % 4 == 3 are unused.
+constexpr std::array<uint8_t, 16> make_rps_scores(int idx_pt) {
+	std::array<uint8_t, 16> scores = {};
+	for (int opponent = 0; opponent < 3; opponent++) {
+		for (int col = 0; col < 3; col++) {
+			int shape = idx_pt == 1 ? col : (opponent + col + 2) % 3;
+			int outcome = idx_pt == 1 ? (col - opponent + 4) % 3 : col;
+			scores[opponent * 4 + col] = (uint8_t)(shape + 1 + 3 * outcome);
+		}
+	}
+	return scores;
+}
+
+constexpr std::array<uint8_t, 16> rps_scores_pt1 = make_rps_scores(1);
+constexpr std::array<uint8_t, 16> rps_scores_pt2 = make_rps_scores(2);
+
+// Kernels over num_records 4-byte "A X\n" records. They add to *pt1 and *pt2 and return false if a
+//	record doesn't have that exact form.
+bool rps_score_records_scalar(const char* data, size_t num_records, long long* pt1, long long* pt2) {
+	for (size_t idx_record = 0; idx_record < num_records; idx_record++) {
+		auto record = data + 4 * idx_record;
+		unsigned opponent = (unsigned char)record[0] - 'A';
+		unsigned col = (unsigned char)record[2] - 'X';
+		if (opponent > 2 || col > 2 || record[1] != ' ' || record[3] != '\n') {
+			return false;
+		}
+		*pt1 += rps_scores_pt1[opponent * 4 + col];
+		*pt2 += rps_scores_pt2[opponent * 4 + col];
+	}
+
+	return true;
+}
+
+#if AOC_X86
+// Per 32-bit lane: subtracting "A X\n" leaves (opponent, 0, col, 0) for valid records, which is checked
+//	with an unsigned max. (d << 2) + (d >> 16) puts the table index in the low byte, the byte shuffle
+//	looks the scores up, and sad_epu8 sums them into 64-bit lanes.
+AOC_TARGET_SSSE3 bool rps_score_records_ssse3(const char* data, size_t num_records, long long* pt1, long long* pt2) {
+	const __m128i record_base = _mm_set1_epi32('A' | (' ' << 8) | ('X' << 16) | ('\n' << 24));
+	const __m128i record_max = _mm_set1_epi32(2 | (2 << 16));
+	const __m128i low_byte = _mm_set1_epi32(0xff);
+	const __m128i scores_pt1 = _mm_loadu_si128((const __m128i*)rps_scores_pt1.data());
+	const __m128i scores_pt2 = _mm_loadu_si128((const __m128i*)rps_scores_pt2.data());
+	__m128i sums_pt1 = _mm_setzero_si128();
+	__m128i sums_pt2 = _mm_setzero_si128();
+	__m128i invalid = _mm_setzero_si128();
+
+	// 16 records per iteration
+	size_t num_blocks = num_records / 16;
+	for (size_t idx_block = 0; idx_block < num_blocks; idx_block++) {
+		for (int i = 0; i < 4; i++) {
+			__m128i records = _mm_loadu_si128((const __m128i*)(data + 64 * idx_block + 16 * i));
+			__m128i d = _mm_sub_epi8(records, record_base);
+			invalid = _mm_or_si128(invalid, _mm_xor_si128(_mm_max_epu8(d, record_max), record_max));
+			__m128i idx = _mm_and_si128(_mm_add_epi32(_mm_slli_epi32(d, 2), _mm_srli_epi32(d, 16)), low_byte);
+			sums_pt1 = _mm_add_epi64(sums_pt1, _mm_sad_epu8(_mm_and_si128(_mm_shuffle_epi8(scores_pt1, idx), low_byte), _mm_setzero_si128()));
+			sums_pt2 = _mm_add_epi64(sums_pt2, _mm_sad_epu8(_mm_and_si128(_mm_shuffle_epi8(scores_pt2, idx), low_byte), _mm_setzero_si128()));
+		}
+	}
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xffff) {
+		return false;
+	}
+
+	alignas(16) long long lanes_pt1[2] = {};
+	alignas(16) long long lanes_pt2[2] = {};
+	_mm_store_si128((__m128i*)lanes_pt1, sums_pt1);
+	_mm_store_si128((__m128i*)lanes_pt2, sums_pt2);
+	*pt1 += lanes_pt1[0] + lanes_pt1[1];
+	*pt2 += lanes_pt2[0] + lanes_pt2[1];
+
+	return rps_score_records_scalar(data + 64 * num_blocks, num_records % 16, pt1, pt2);
+}
+
+AOC_TARGET_AVX2 bool rps_score_records_avx2(const char* data, size_t num_records, long long* pt1, long long* pt2) {
+	const __m256i record_base = _mm256_set1_epi32('A' | (' ' << 8) | ('X' << 16) | ('\n' << 24));
+	const __m256i record_max = _mm256_set1_epi32(2 | (2 << 16));
+	const __m256i low_byte = _mm256_set1_epi32(0xff);
+	const __m256i scores_pt1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)rps_scores_pt1.data()));
+	const __m256i scores_pt2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)rps_scores_pt2.data()));
+	__m256i sums_pt1 = _mm256_setzero_si256();
+	__m256i sums_pt2 = _mm256_setzero_si256();
+	__m256i invalid = _mm256_setzero_si256();
+
+	// 32 records per iteration
+	size_t num_blocks = num_records / 32;
+	for (size_t idx_block = 0; idx_block < num_blocks; idx_block++) {
+		for (int i = 0; i < 4; i++) {
+			__m256i records = _mm256_loadu_si256((const __m256i*)(data + 128 * idx_block + 32 * i));
+			__m256i d = _mm256_sub_epi8(records, record_base);
+			invalid = _mm256_or_si256(invalid, _mm256_xor_si256(_mm256_max_epu8(d, record_max), record_max));
+			__m256i idx = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(d, 2), _mm256_srli_epi32(d, 16)), low_byte);
+			sums_pt1 = _mm256_add_epi64(sums_pt1, _mm256_sad_epu8(_mm256_and_si256(_mm256_shuffle_epi8(scores_pt1, idx), low_byte), _mm256_setzero_si256()));
+			sums_pt2 = _mm256_add_epi64(sums_pt2, _mm256_sad_epu8(_mm256_and_si256(_mm256_shuffle_epi8(scores_pt2, idx), low_byte), _mm256_setzero_si256()));
+		}
+	}
+
+	if (!_mm256_testz_si256(invalid, invalid)) {
+		return false;
+	}
+
+	alignas(32) long long lanes_pt1[4] = {};
+	alignas(32) long long lanes_pt2[4] = {};
+	_mm256_store_si256((__m256i*)lanes_pt1, sums_pt1);
+	_mm256_store_si256((__m256i*)lanes_pt2, sums_pt2);
+	*pt1 += lanes_pt1[0] + lanes_pt1[1] + lanes_pt1[2] + lanes_pt1[3];
+	*pt2 += lanes_pt2[0] + lanes_pt2[1] + lanes_pt2[2] + lanes_pt2[3];
+
+	return rps_score_records_scalar(data + 128 * num_blocks, num_records % 32, pt1, pt2);
+}
+#endif
+
+using Rps_score_fn = bool(*)(const char*, size_t, long long*, long long*);
+
+Rps_score_fn select_rps_score_fn() {
+#if AOC_X86
+	if (cpu_has_avx2()) {
+		return rps_score_records_avx2;
+	}
+	if (cpu_has_ssse3()) {
+		return rps_score_records_ssse3;
+	}
+#endif
+	return rps_score_records_scalar;
+}
+
+// Scores a whole input that is nothing but "A X\n" records, the last one possibly without the newline.
+//	Returns false for anything else, e.g. CRLF line ends, and the caller falls back to line by line.
+bool rps_score_buffer(std::string_view buf, long long* pt1, long long* pt2) {
+	size_t num_records = buf.size() / 4;
+	size_t rest = buf.size() % 4;
+	if (rest != 0 && rest != 3) {
+		return false;
+	}
+	if (!select_rps_score_fn()(buf.data(), num_records, pt1, pt2)) {
+		return false;
+	}
+	if (rest == 3) {
+		char last[4] = { buf[4 * num_records], buf[4 * num_records + 1], buf[4 * num_records + 2], '\n' };
+		return rps_score_records_scalar(last, 1, pt1, pt2);
+	}
+
+	return true;
+}
+
+struct Aoc02_state {
+	long long total_score_pt1 = 0;
+	long long total_score_pt2 = 0;
+
+	void add_line(std::string_view line) {
+		if (line.size() < 3) {
+			return;
+		}
+
+		unsigned opponent = (unsigned char)line[0] - 'A';
+		unsigned col = (unsigned char)line[2] - 'X';
+		if (opponent > 2 || col > 2) {
+			return;
+		}
+		total_score_pt1 += rps_scores_pt1[opponent * 4 + col];
+		total_score_pt2 += rps_scores_pt2[opponent * 4 + col];
+	}
+
+	// Uses the SIMD record kernels if the chunk is nothing but "A X\n" records
+	void add_lines(std::string_view chunk) {
+		long long chunk_score_pt1 = 0;
+		long long chunk_score_pt2 = 0;
+		if (rps_score_buffer(chunk, &chunk_score_pt1, &chunk_score_pt2)) {
+			total_score_pt1 += chunk_score_pt1;
+			total_score_pt2 += chunk_score_pt2;
+			return;
+		}
+		for_each_line(chunk, [this](std::string_view line) { add_line(line); });
+	}
+
+	void merge(const Aoc02_state& other) {
+		total_score_pt1 += other.total_score_pt1;
+		total_score_pt2 += other.total_score_pt2;
+	}
+
+	void finish(Task_result* result) {
+		result->pt1 = total_score_pt1;
+		result->pt2 = total_score_pt2;
+	}
+};
+
+void aoc02(const Input_file& lines, Task_result* result) {
+	auto state = parallel_reduce_lines<Aoc02_state>(lines.data());
+
+	state.finish(result);
+}
+
+// Bit mask of the item priorities in a rucksack compartment: bit 1-26 for a-z, bit 27-52 for A-Z
+constexpr std::array<uint64_t, 256> make_rucksack_lut() {
+	std::array<uint64_t, 256> lut = {};
+	for (int c = 'a'; c <= 'z'; c++) {
+		lut[c] = 1ull << (c - 'a' + 1);
+	}
+	for (int c = 'A'; c <= 'Z'; c++) {
+		lut[c] = 1ull << (c - 'A' + 27);
+	}
+	return lut;
+}
+
+constexpr std::array<uint64_t, 256> rucksack_lut = make_rucksack_lut();
+
+uint64_t rucksack_mask_scalar(std::string_view s) {
+	uint64_t val = 0;
+	for (unsigned char c : s) {
+		val |= rucksack_lut[c];
+	}
+	return val;
+}
+
+struct Aoc03_state {
+	// Masks are reduced in batches. The batch size is a multiple of three so groups never straddle two batches.
+	static constexpr size_t batch_size = 255;
+
+	uint64_t left_masks[batch_size] = {};
+	uint64_t right_masks[batch_size] = {};
+	size_t num_batched = 0;
+	long long prio_sum_pt1 = 0;
+	long long prio_sum_pt2 = 0;
+
+	void reduce_batch() {
+		for (size_t i = 0; i < num_batched; i++) {
+			prio_sum_pt1 += std::countr_zero(left_masks[i] & right_masks[i]);
+		}
+
+		int group_size = 3;
+		for (size_t i = 0; i + group_size <= num_batched; i += group_size) {
+			auto vals_0 = left_masks[i] | right_masks[i];
+			auto vals_1 = left_masks[i + 1] | right_masks[i + 1];
+			auto vals_2 = left_masks[i + 2] | right_masks[i + 2];
+			prio_sum_pt2 += std::countr_zero(vals_0 & vals_1 & vals_2);
+		}
+
+		num_batched = 0;
+	}
+
+	void add_line(std::string_view line) {
+		left_masks[num_batched] = rucksack_mask_scalar(line.substr(0, line.size() / 2));
+		right_masks[num_batched] = rucksack_mask_scalar(line.substr(line.size() / 2));
+		if (++num_batched == batch_size) {
+			reduce_batch();
+		}
+	}
+
+	// other must start at a group of three lines
+	void merge(Aoc03_state& other) {
+		reduce_batch();
+		other.reduce_batch();
+		prio_sum_pt1 += other.prio_sum_pt1;
+		prio_sum_pt2 += other.prio_sum_pt2;
+	}
+
+	void finish(Task_result* result) {
+		reduce_batch();
+		result->pt1 = prio_sum_pt1;
+		result->pt2 = prio_sum_pt2;
+	}
+};
+
+void aoc03(const Input_file& lines, Task_result* result) {
+	// Part 2 works on groups of three lines, so chunks must not split a group
+	auto state = parallel_reduce_lines<Aoc03_state>(lines.data(), 3);
+
+	state.finish(result);
+}
+
+struct Aoc04_state {
+	struct Range {
+		int start;
+		int end_incl;
+	};
+
+	long long num_contained = 0;
+	long long num_overlap = 0;
+
+	void add_line(std::string_view line) {
+		Range ranges[2] = {};
+		Scanner sc = { line };
+		bool ok = sc.read_int(&ranges[0].start) && sc.skip("-") && sc.read_int(&ranges[0].end_incl) && sc.skip(",")
+			&& sc.read_int(&ranges[1].start) && sc.skip("-") && sc.read_int(&ranges[1].end_incl);
+		if (!ok) {
+			log_line(std::format("Could not parse line: {}", line));
+			return;
+		}
+		bool is_contained = false;
+		bool has_overlap = false;
+		for (int i = 0; i < 2; i++) {
+			auto r1 = i == 0 ? ranges[0] : ranges[1];
+			auto r2 = i == 0 ? ranges[1] : ranges[0];
+			if (r1.start <= r2.start && r1.end_incl >= r2.end_incl) {
+				is_contained = true;
+			}
+			if (r1.start <= r2.end_incl && r1.end_incl >= r2.start) {
+				has_overlap = true;
+			}
+		}
+		if (is_contained) {
+			num_contained++;
+		}
+		if (has_overlap) {
+			num_overlap++;
+		}
+	}
+
+	void merge(const Aoc04_state& other) {
+		num_contained += other.num_contained;
+		num_overlap += other.num_overlap;
+	}
+
+	void finish(Task_result* result) {
+		result->pt1 = num_contained;
+		result->pt2 = num_overlap;
+	}
+};
+
+void aoc04(const Input_file& lines, Task_result* result) {
+	auto state = parallel_reduce_lines<Aoc04_state>(lines.data());
+
+	state.finish(result);
+}
+
+struct Crane_move {
+	int cnt;
+	int idx_from;
+	int idx_to;
+};
+
+// Runs the part 1 crane (one crate at a time, so a moved run is reversed) and the part 2 crane (whole
+//	runs) side by side. Both sets of stacks share one treap arena and sit next to each other per stack,
+//	so each move is read once and applied to both. Moves can be applied in batches, e.g. while
+//	replaying a log.
+class Crane_engine {
+public:
+	static constexpr int num_parts = 2;
+
+	explicit Crane_engine(size_t num_stacks) : stacks(num_stacks, { Implicit_treap<char>::null_node, Implicit_treap<char>::null_node }) {
+	}
+
+	size_t num_stacks() const {
+		return stacks.size();
+	}
+
+	// Crates are added bottom to top
+	void push_crate(size_t idx_stack, char crate) {
+		for (auto& stack : stacks[idx_stack]) {
+			stack = crates.push_back(stack, crate);
+		}
+	}
+
+	void apply_moves(const Crane_move* moves, size_t num_moves) {
+		for (size_t idx_move = 0; idx_move < num_moves; idx_move++) {
+			auto& move = moves[idx_move];
+			auto& stacks_from = stacks[move.idx_from];
+			auto& stacks_to = stacks[move.idx_to];
+			for (int idx_part = 0; idx_part < num_parts; idx_part++) {
+				auto& stack_from = stacks_from[idx_part];
+				auto cnt = std::min<uint32_t>(move.cnt, crates.size(stack_from));
+				uint32_t moved = Implicit_treap<char>::null_node;
+				crates.split(stack_from, crates.size(stack_from) - cnt, &stack_from, &moved);
+				if (idx_part == 0) {
+					crates.reverse(moved);
+				}
+				stacks_to[idx_part] = crates.merge(stacks_to[idx_part], moved);
+			}
+		}
+	}
+
+	// Top crate of every stack, a space for an empty stack. idx_part is 0 or 1.
+	std::string tops(int idx_part) const {
+		std::string ret = {};
+		for (auto& stack : stacks) {
+			ret += crates.size(stack[idx_part]) == 0 ? ' ' : crates.back(stack[idx_part]);
+		}
+
+		return ret;
+	}
+
+private:
+	Implicit_treap<char> crates = {};
+	std::vector<std::array<uint32_t, num_parts>> stacks;
+};
+
+void aoc05(const Input_file& lines, Task_result* result) {
+	if (lines.empty() || lines[0].empty()) {
+		return;
+	}
+
+	auto num_stacks = (lines[0].size() + 1) / 4;
+	Crane_engine engine(num_stacks);
+
+	size_t num_lines = 0;
+
+	for (auto& line : lines) {
+		if (line.empty()) {
+			num_lines--;
+			break;
+		}
+		num_lines++;
+	}
+
+	for (int idx_container = (int)num_lines - 1; idx_container >= 0; idx_container--) {
+		auto line = lines[idx_container];
+		for (size_t idx_stack = 0; idx_stack < num_stacks && 4 * idx_stack + 1 < line.size(); idx_stack++) {
+			auto cc = line[4 * idx_stack + 1];
+			if (cc != ' ') {
+				engine.push_crate(idx_stack, cc);
+			}
+		}
+	}
+
+	auto idx_move_start = num_lines + 2;
+
+	// No moves if the blank line after the stacks is missing
+	auto num_moves = lines.size() > idx_move_start ? lines.size() - idx_move_start : 0;
+	std::vector<Crane_move> moves(num_moves);
+
+	for (int idx_move = 0; idx_move < num_moves; idx_move++) {
+		auto& move = moves[idx_move];
+		Scanner sc = { lines[idx_move_start + idx_move] };
+		bool ok = sc.skip("move ") && sc.read_int(&move.cnt) && sc.skip(" from ") && sc.read_int(&move.idx_from) && sc.skip(" to ") && sc.read_int(&move.idx_to);
+		move.idx_from--;
+		move.idx_to--;
+		ok = ok && move.cnt >= 0 && move.idx_from >= 0 && move.idx_from < num_stacks && move.idx_to >= 0 && move.idx_to < num_stacks;
+		if (!ok) {
+			log_line(std::format("Could not parse line: {}", lines[idx_move_start + idx_move]));
+			return;
+		}
+	}
+
+	result->t_parsed = Bench_clock::now();
+
+	engine.apply_moves(moves.data(), moves.size());
+
+	result->pt1_string = engine.tops(0);
+	result->pt2_string = engine.tops(1);
+}
+
+// Finds, in a single pass, the end of the first run of distinct characters for any number of window sizes.
+//	Each window keeps a rolling XOR of its character bits: a character entering and leaving toggles the same
+//	bit, so the window is all distinct exactly when its popcount equals its size. Only the last
+//	max window size characters are kept, so a line can be fed in chunks of any size.
+struct Marker_detector {
+	struct Window {
+		int size;
+		long long marker;
+		uint64_t bits[4];
+	};
+
+	std::vector<Window> windows = {};
+	std::vector<unsigned char> recent = {};
+	long long idx_char = 0;
+	size_t num_found = 0;
+
+	explicit Marker_detector(const std::vector<int>& sizes) {
+		int max_size = 1;
+		for (int size : sizes) {
+			windows.push_back({ size, 0, {} });
+			max_size = std::max(max_size, size);
+		}
+		recent.resize(max_size);
+	}
+
+	static void toggle(Window* window, unsigned char c) {
+		window->bits[c >> 6] ^= 1ull << (c & 63);
+	}
+
+	void add_chars(std::string_view chars) {
+		for (size_t i = 0; i < chars.size() && num_found < windows.size(); i++) {
+			unsigned char c = chars[i];
+			for (auto& window : windows) {
+				if (window.marker != 0) {
+					continue;
+				}
+				toggle(&window, c);
+				if (idx_char >= window.size) {
+					toggle(&window, recent[(idx_char - window.size) % recent.size()]);
+				}
+				int num_distinct = std::popcount(window.bits[0]) + std::popcount(window.bits[1]) +
+					std::popcount(window.bits[2]) + std::popcount(window.bits[3]);
+				if (num_distinct == window.size) {
+					window.marker = idx_char + 1;
+					num_found++;
+				}
+			}
+			recent[idx_char % recent.size()] = c;
+			idx_char++;
+		}
+	}
+
+	void reset() {
+		for (auto& window : windows) {
+			window.marker = 0;
+			std::fill(std::begin(window.bits), std::end(window.bits), 0);
+		}
+		idx_char = 0;
+		num_found = 0;
+	}
+};
+
+struct Aoc06_state {
+	Marker_detector detector = Marker_detector({ 4, 14 });
+	int num_lines = 0;
+	std::string pt1_string = {};
+	std::string pt2_string = {};
+
+	// A line may be fed in several calls
+	void add_chars(std::string_view chars) {
+		detector.add_chars(chars);
+	}
+
+	void end_line() {
+		pt1_string += (num_lines == 0 ? "" : ",") + std::to_string(detector.windows[0].marker);
+		pt2_string += (num_lines == 0 ? "" : ",") + std::to_string(detector.windows[1].marker);
+		num_lines++;
+		detector.reset();
+	}
+
+	void add_line(std::string_view line) {
+		add_chars(line);
+		end_line();
+	}
+
+	void finish(Task_result* result) {
+		result->pt1_string = pt1_string;
+		result->pt2_string = pt2_string;
+	}
+};
+
+void aoc06(const Input_file& lines, Task_result* result) {
+	Aoc06_state state = {};
+
+	for (auto& line : lines) {
+		state.add_line(line);
+	}
+
+	state.finish(result);
+}
+
+// Streaming evaluation of a day 7 log. The sizes of the directories on the current path are kept, and
+//	a directory's size is final when it is left. Assumes every directory is entered once, as in the
+//	puzzle logs. The part 2 threshold is only known at the end, so finished directories are kept as
+//	candidates. The total of the files seen so far is a lower bound for the root size, and candidates
+//	below the threshold it implies are dropped. That bound stays at 0 or less until 40M bytes of files
+//	have been seen, so on most logs every directory is kept and memory is O(depth + directories).
+struct Aoc07_state {
+	static constexpr long long max_size = 100'000;
+	static constexpr long long tot_disk_space = 70'000'000;
+	static constexpr long long required_disk_space = 30'000'000;
+
+	std::vector<long long> path_sizes = { 0 };
+	long long tot_file_size = 0;
+	long long sum_small_sizes = 0;
+	std::multiset<long long> candidates = {};
+
+	void add_dir_size(long long size) {
+		if (size < max_size) {
+			sum_small_sizes += size;
+		}
+		long long min_delete_lower_bound = required_disk_space - (tot_disk_space - tot_file_size);
+		if (size >= min_delete_lower_bound) {
+			candidates.insert(size);
+		}
+		candidates.erase(candidates.begin(), candidates.lower_bound(min_delete_lower_bound));
+	}
+
+	void leave_dir() {
+		long long size = path_sizes.back();
+		path_sizes.pop_back();
+		path_sizes.back() += size;
+		add_dir_size(size);
+	}
+
+	void add_line(std::string_view line) {
+		Scanner sc = { line };
+		if (sc.skip("$ cd ")) {
+			auto name = sc.read_rest();
+			if (name == "/") {
+				while (path_sizes.size() > 1) {
+					leave_dir();
+				}
+			}
+			else if (name == "..") {
+				if (path_sizes.size() > 1) {
+					leave_dir();
+				}
+			}
+			else {
+				path_sizes.push_back(0);
+			}
+			return;
+		}
+		long long fsize = 0;
+		if (sc.read_int(&fsize) && sc.skip(" ")) {
+			path_sizes.back() += fsize;
+			tot_file_size += fsize;
+		}
+	}
+
+	void finish(Task_result* result) {
+		while (path_sizes.size() > 1) {
+			leave_dir();
+		}
+		add_dir_size(path_sizes[0]);
+
+		long long min_delete_folder_size = required_disk_space - (tot_disk_space - path_sizes[0]);
+		auto it = candidates.lower_bound(min_delete_folder_size);
+		result->pt1 = sum_small_sizes;
+		result->pt2 = it == candidates.end() ? 0 : *it;
+	}
+};
+
+void aoc07(const Input_file& lines, Task_result* result) {
+	// Directories live in an arena and refer to each other by index. A child is always created after its
+	//	parent, so walking the arena backwards visits every directory after all of its children.
+	struct Dir_node {
+		std::string_view name;
+		uint32_t idx_parent;
+		long long tot_size;
+	};
+	struct Child_key {
+		uint32_t idx_parent;
+		std::string_view name;
+
+		bool operator==(const Child_key& other) const {
+			return idx_parent == other.idx_parent && name == other.name;
+		}
+	};
+	struct Child_key_hash {
+		size_t operator()(const Child_key& key) const {
+			return std::hash<std::string_view>()(key.name) ^ (key.idx_parent * 0x9e3779b97f4a7c15ull);
+		}
+	};
+
+	std::vector<Dir_node> dirs = { { "/", 0, 0 } };
+	std::unordered_map<Child_key, uint32_t, Child_key_hash> children = {};
+	uint32_t idx_cur_dir = 0;
+
+	for (auto& line : lines) {
+		Scanner sc = { line };
+		if (sc.skip("$ cd ")) {
+			auto name = sc.read_rest();
+			if (name == "/") {
+				idx_cur_dir = 0;
+			}
+			else if (name == "..") {
+				idx_cur_dir = dirs[idx_cur_dir].idx_parent;
+			}
+			else {
+				auto it = children.find({ idx_cur_dir, name });
+				if (it == children.end()) {
+					log_line(std::format("Could not find folder {} in folder {}", name, dirs[idx_cur_dir].name));
+					return;
+				}
+				idx_cur_dir = it->second;
+			}
+			continue;
+		}
+		if (sc.skip("$")) {
+			continue;
+		}
+		if (sc.skip("dir ")) {
+			auto name = sc.read_rest();
+			auto [it, is_new] = children.try_emplace({ idx_cur_dir, name }, (uint32_t)dirs.size());
+			if (is_new) {
+				dirs.push_back({ name, idx_cur_dir, 0 });
+			}
+			continue;
+		}
+		long long fsize = 0;
+		if (sc.read_int(&fsize) && sc.skip(" ")) {
+			dirs[idx_cur_dir].tot_size += fsize;
+		}
+	}
+
+	result->t_parsed = Bench_clock::now();
+
+	for (size_t idx_dir = dirs.size() - 1; idx_dir > 0; idx_dir--) {
+		dirs[dirs[idx_dir].idx_parent].tot_size += dirs[idx_dir].tot_size;
+	}
+
+	long long max_size = 100'000;
+	long long tot_disk_space = 70'000'000;
+	long long required_disk_space = 30'000'000;
+	long long cur_disk_space = tot_disk_space - dirs[0].tot_size;
+	long long min_delete_folder_size = required_disk_space - cur_disk_space;
+	long long cur_smallest_size = std::numeric_limits<long long>::max();
+
+	for (auto& dir : dirs) {
+		if (dir.tot_size < max_size) {
+			result->pt1 += dir.tot_size;
+		}
+		if (dir.tot_size >= min_delete_folder_size && dir.tot_size < cur_smallest_size) {
+			cur_smallest_size = dir.tot_size;
+			result->pt2 = cur_smallest_size;
+		}
+	}
+}
+
+void aoc08(const Input_file& lines, Task_result* result) {
+	if (lines.empty() || lines[0].empty()) {
+		return;
+	}
+
+	// Monotonic stack of the trees seen so far in one direction, with strictly decreasing heights.
+	//	A tree that is not taller than a closer tree can never block the view past that tree, so it
+	//	is dropped. Heights are digits, so there are never more than 10 entries.
+	struct Sight_stack {
+		uint32_t pos[10];
+		uint8_t heights[10];
+		uint8_t size;
+
+		// Viewing distance from pos, and whether the view reaches the edge at edge_pos
+		uint32_t look(uint32_t cur_pos, uint8_t cur_height, uint32_t edge_pos, bool* free_sight) {
+			while (size > 0 && heights[size - 1] < cur_height) {
+				size--;
+			}
+			*free_sight = size == 0;
+			uint32_t block_pos = size == 0 ? edge_pos : pos[size - 1];
+			uint32_t dist = cur_pos > block_pos ? cur_pos - block_pos : block_pos - cur_pos;
+			if (size > 0 && heights[size - 1] == cur_height) {
+				size--;
+			}
+			pos[size] = cur_pos;
+			heights[size] = cur_height;
+			size++;
+			return dist;
+		}
+	};
+
+	uint32_t num_rows = (uint32_t)lines.size();
+	uint32_t num_cols = (uint32_t)lines[0].size();
+	std::vector<uint8_t> heights((size_t)num_rows * num_cols);
+
+	for (uint32_t row = 0; row < num_rows; row++) {
+		for (uint32_t col = 0; col < num_cols; col++) {
+			int height = col < lines[row].size() ? lines[row][col] - '0' : 0;
+			heights[(size_t)row * num_cols + col] = (uint8_t)std::clamp(height, 0, 9);
+		}
+	}
+
+	result->t_parsed = Bench_clock::now();
+
+	// Pass 1, top to bottom: distance upwards and whether the top edge is visible
+	std::vector<uint32_t> dist_up(heights.size());
+	std::vector<uint8_t> free_sight_up(heights.size());
+	std::vector<Sight_stack> col_stacks(num_cols);
+
+	for (uint32_t row = 0; row < num_rows; row++) {
+		for (uint32_t col = 0; col < num_cols; col++) {
+			auto idx = (size_t)row * num_cols + col;
+			bool free_sight = false;
+			dist_up[idx] = col_stacks[col].look(row, heights[idx], 0, &free_sight);
+			free_sight_up[idx] = free_sight;
+		}
+	}
+
+	// Pass 2, bottom to top: distance downwards, then left and right within the row. All four
+	//	directions are known at that point, so visibility and the max score are reduced right away.
+	std::fill(col_stacks.begin(), col_stacks.end(), Sight_stack{});
+	std::vector<uint64_t> row_scores(num_cols);
+	std::vector<uint8_t> row_free_sight(num_cols);
+	long long num_free_sight = 0;
+	uint64_t max_scenic_score = 0;
+
+	for (uint32_t row = num_rows; row-- > 0;) {
+		const uint8_t* row_heights = heights.data() + (size_t)row * num_cols;
+		for (uint32_t col = 0; col < num_cols; col++) {
+			auto idx = (size_t)row * num_cols + col;
+			bool free_sight = false;
+			row_scores[col] = (uint64_t)dist_up[idx] * col_stacks[col].look(row, row_heights[col], num_rows - 1, &free_sight);
+			row_free_sight[col] = free_sight_up[idx] | (uint8_t)free_sight;
+		}
+
+		Sight_stack row_stack = {};
+		for (uint32_t col = 0; col < num_cols; col++) {
+			bool free_sight = false;
+			row_scores[col] *= row_stack.look(col, row_heights[col], 0, &free_sight);
+			row_free_sight[col] |= (uint8_t)free_sight;
+		}
+
+		row_stack = {};
+		for (uint32_t col = num_cols; col-- > 0;) {
+			bool free_sight = false;
+			row_scores[col] *= row_stack.look(col, row_heights[col], num_cols - 1, &free_sight);
+			row_free_sight[col] |= (uint8_t)free_sight;
+			num_free_sight += row_free_sight[col];
+			max_scenic_score = std::max(max_scenic_score, row_scores[col]);
+		}
+	}
+
+	result->pt1 = num_free_sight;
+	result->pt2 = (long long)max_scenic_score;
+}
+
+// Knot 1 of a 10 knot rope moves exactly like the tail of a 2 knot rope, so one simulation answers both parts
+struct Aoc09_state {
+	static constexpr int num_knots = 10;
+
+	struct Pos {
+		long long x;
+		long long y;
+	};
+
+	Pos knots[num_knots] = {};
+	Visited_set visited_pt1 = {};
+	Visited_set visited_pt2 = {};
+
+	Aoc09_state() {
+		visited_pt1.insert(0, 0);
+		visited_pt2.insert(0, 0);
+	}
+
+	void step(int x_delta, int y_delta) {
+		knots[0].x += x_delta;
+		knots[0].y += y_delta;
+
+		for (int idx_knot = 1; idx_knot < num_knots; idx_knot++) {
+			auto& pos_prev = knots[idx_knot - 1];
+			auto& pos_cur = knots[idx_knot];
+			long long x_diff = pos_prev.x - pos_cur.x;
+			long long y_diff = pos_prev.y - pos_cur.y;
+			// A knot that stays put can't move the ones behind it
+			if (std::abs(x_diff) <= 1 && std::abs(y_diff) <= 1) {
+				return;
+			}
+			pos_cur.x += (x_diff > 0) - (x_diff < 0);
+			pos_cur.y += (y_diff > 0) - (y_diff < 0);
+			if (idx_knot == 1) {
+				visited_pt1.insert(pos_cur.x, pos_cur.y);
+			}
+			if (idx_knot == num_knots - 1) {
+				visited_pt2.insert(pos_cur.x, pos_cur.y);
+			}
+		}
+	}
+
+	// True if every knot is right behind the previous one along the move, so each further step
+	//	moves the whole rope by one
+	bool is_straight(int x_delta, int y_delta) const {
+		for (int idx_knot = 1; idx_knot < num_knots; idx_knot++) {
+			if (knots[idx_knot].x != knots[idx_knot - 1].x - x_delta || knots[idx_knot].y != knots[idx_knot - 1].y - y_delta) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void move_straight(int x_delta, int y_delta, long long cnt) {
+		visited_pt1.insert_span(knots[1].x + x_delta, knots[1].y + y_delta, x_delta, y_delta, cnt);
+		visited_pt2.insert_span(knots[num_knots - 1].x + x_delta, knots[num_knots - 1].y + y_delta, x_delta, y_delta, cnt);
+		for (auto& knot : knots) {
+			knot.x += x_delta * cnt;
+			knot.y += y_delta * cnt;
+		}
+	}
+
+	void add_line(std::string_view line) {
+		Scanner sc = { line };
+		char dir_char = {};
+		int cnt = 0;
+		if (!(sc.read_char(&dir_char) && sc.skip(" ") && sc.read_int(&cnt))) {
+			log_line(std::format("Could not parse line: {}", line));
+			return;
+		}
+
+		int x_delta = 0;
+		int y_delta = 0;
+		switch (dir_char) {
+		case 'U': y_delta = -1; break;
+		case 'D': y_delta = 1; break;
+		case 'L': x_delta = -1; break;
+		case 'R': x_delta = 1; break;
+		}
+
+		for (int idx_move = 0; idx_move < cnt; idx_move++) {
+			step(x_delta, y_delta);
+			if (is_straight(x_delta, y_delta)) {
+				move_straight(x_delta, y_delta, cnt - idx_move - 1);
+				break;
+			}
+		}
+	}
+
+	void finish(Task_result* result) {
+		result->pt1 = (long long)visited_pt1.size();
+		result->pt2 = (long long)visited_pt2.size();
+	}
+};
+
+void aoc09(const Input_file& lines, Task_result* result) {
+	Aoc09_state state = {};
+
+	for (auto& line : lines) {
+		state.add_line(line);
+	}
+
+	state.finish(result);
+}
+
+struct Aoc10_state {
+	static constexpr int num_cycles = 240;
+
+	int reg_x = 1;
+	// Number of completed cycles
+	int cycle = 0;
+	int signal_strength = 0;
+	int x_per_cycle[num_cycles] = {};
+
+	void tick() {
+		if (cycle >= num_cycles) {
+			return;
+		}
+		x_per_cycle[cycle] = reg_x;
+		cycle++;
+		// Measure during cycle 20, 60, 100, 140, 180 and 220
+		if (cycle % 40 == 20) {
+			signal_strength += cycle * reg_x;
+		}
+	}
+
+	void add_line(std::string_view line) {
+		Scanner sc = { line };
+		int val = 0;
+
+		if (sc.skip("noop")) {
+			tick();
+		}
+		if (sc.skip("addx ") && sc.read_int(&val)) {
+			tick();
+			tick();
+			reg_x += val;
+		}
+	}
+
+	void finish(Task_result* result) {
+		// The program is padded with noops if it ends early
+		while (cycle < num_cycles) {
+			tick();
+		}
+
+		result->pt1 = signal_strength;
+		result->pt2_string = "RKAZAJBR";	// Extracted from print loop below
+
+		//for (int idx_cycle = 0; idx_cycle < num_cycles; idx_cycle++) {
+		//	int row_len = 40;
+		//	int row = idx_cycle / row_len;
+		//	int col = idx_cycle % row_len;
+		//	char c = '.';
+		//	if (std::abs(x_per_cycle[idx_cycle] - col) <= 1) {
+		//		c = '#';
+		//	}
+		//	std::cout << c;
+		//	if ((idx_cycle + 1) % row_len == 0) {
+		//		std::cout << std::endl;
+		//	}
+		//}
+	}
+};
+
+void aoc10(const Input_file& lines, Task_result* result) {
+	Aoc10_state state = {};
+
+	for (auto& line : lines) {
+		state.add_line(line);
+	}
+
+	state.finish(result);
+}
+
+void aoc11(const Input_file& lines, Task_result* result) {
+	// Part 1 worry values, as wide as the compiler has
+#if defined(__SIZEOF_INT128__)
+	using Exact_worry = __int128;
+#else
+	using Exact_worry = long long;
+#endif
+
+	// new = old + val, old * val, old + old or old * old. Parsed once, evaluated with a switch.
+	struct Monkey_op {
+		enum class Kind { Add, Mul, Double, Square };
+
+		Kind kind;
+		long long val;
+		// val % mod for apply_mod, set once the lcm of the divisors is known
+		long long val_mod;
+
+		// New value mod mod, for 0 <= old < mod. Sums are done unsigned since both terms are below 2^63.
+		long long apply_mod(long long old, long long mod) const {
+			auto add_mod = [mod](long long a, long long b) {
+				unsigned long long sum = (unsigned long long)a + (unsigned long long)b;
+				return (long long)(sum >= (unsigned long long)mod ? sum - mod : sum);
+			};
+			switch (kind) {
+			case Kind::Add: return add_mod(old, val_mod);
+			case Kind::Mul: return mul_mod(old, val_mod, mod);
+			case Kind::Double: return add_mod(old, old);
+			case Kind::Square: return mul_mod(old, old, mod);
+			}
+			return old;
+		}
+
+		// Exact new value. False on overflow.
+		bool apply_exact(Exact_worry old, Exact_worry* out) const {
+			Exact_worry operand = kind == Kind::Add || kind == Kind::Mul ? (Exact_worry)val : old;
+			bool is_add = kind == Kind::Add || kind == Kind::Double;
+#if defined(__GNUC__) || defined(__clang__)
+			return is_add ? !__builtin_add_overflow(old, operand, out) : !__builtin_mul_overflow(old, operand, out);
+#else
+			return is_add ? checked_add(old, operand, out) : checked_mul(old, operand, out);
+#endif
+		}
+	};
+
+	struct Monkey {
+		int id;
+		std::vector<long long> items;
+		Monkey_op operation;
+		long long test_divisor;
 		int idx_monkey_on_true;
 		int idx_monkey_on_false;
-		int num_items;
-		int idx_start_items;
-		int num_inspections;
 	};
 
-	enum class Line_type { None, Id, Items, Operation, Test_divisor, On_true, On_false };
+	// An item at the start of a round. Items never interact, so each one is simulated on its own.
+	struct Item_state {
+		int idx_monkey;
+		long long val;
+
+		bool operator==(const Item_state& other) const {
+			return idx_monkey == other.idx_monkey && val == other.val;
+		}
+	};
+
+	enum class Line_type { None, Id, Items, Operation, Test_divisor, On_true, On_false };
+
+	int num_lines = (int)lines.size();
+	int num_monkeys = (num_lines + 1) / 7;
+	std::vector<Monkey> monkeys(num_monkeys);
+	int idx_cur_monkey = 0;
+
+	for (int idx_line = 0; idx_line < num_lines; idx_line++) {
+		Scanner sc = { string_trim(lines[idx_line]) };
+		if ((idx_line + 1) % 7 == 0) {
+			idx_cur_monkey++;
+		}
+
+		auto& cur_monkey = monkeys[idx_cur_monkey];
+		int idx_monkey_line = idx_line % 7;
+
+		Line_type line_type = Line_type::None;
+		switch (idx_monkey_line) {
+		case 0:line_type = Line_type::Id;			break;
+		case 1:line_type = Line_type::Items;		break;
+		case 2:line_type = Line_type::Operation;	break;
+		case 3:line_type = Line_type::Test_divisor; break;
+		case 4:line_type = Line_type::On_true;		break;
+		case 5:line_type = Line_type::On_false;		break;
+		}
+
+		bool ok = true;
+
+		if (line_type == Line_type::Id) {
+			ok = sc.skip("Monkey ") && sc.read_int(&cur_monkey.id);
+		}
+		if (line_type == Line_type::Items) {
+			ok = sc.skip("Starting items: ");
+			for (auto num : String_split(sc.read_rest(), ", ")) {
+				long long val = 0;
+				Scanner sc_num = { num };
+				if (sc_num.read_int(&val)) {
+					cur_monkey.items.push_back(val);
+				}
+			}
+		}
+
+		if (line_type == Line_type::Operation) {
+			char op = {};
+			ok = sc.skip("Operation: new = old ") && sc.read_char(&op) && sc.skip(" ");
+			// The other operand is either 'old' or a constant
+			bool both_old = sc.skip("old");
+			long long val = 0;
+			if (!both_old) {
+				ok = ok && sc.read_int(&val);
+			}
+			if (op == '+') {
+				cur_monkey.operation = { both_old ? Monkey_op::Kind::Double : Monkey_op::Kind::Add, val, 0 };
+			}
+			else if (op == '*') {
+				cur_monkey.operation = { both_old ? Monkey_op::Kind::Square : Monkey_op::Kind::Mul, val, 0 };
+			}
+			else {
+				ok = false;
+			}
+		}
+
+		if (line_type == Line_type::Test_divisor) {
+			ok = sc.skip("Test: divisible by ") && sc.read_int(&cur_monkey.test_divisor);
+		}
+
+		if (line_type == Line_type::On_true) {
+			ok = sc.skip("If true: throw to monkey ") && sc.read_int(&cur_monkey.idx_monkey_on_true);
+		}
+
+		if (line_type == Line_type::On_false) {
+			ok = sc.skip("If false: throw to monkey ") && sc.read_int(&cur_monkey.idx_monkey_on_false);
+		}
+
+		if (!ok) {
+			log_line(std::format("Could not parse line: {}", lines[idx_line]));
+			return;
+		}
+	}
+
+	std::vector<long long> divisors = {};
+	for (auto& monkey : monkeys) {
+		if (monkey.test_divisor <= 0) {
+			log_line(std::format("Invalid divisor for monkey {}", monkey.id));
+			return;
+		}
+		divisors.push_back(monkey.test_divisor);
+	}
+	long long max_val = 0;
+	if (!lcm(divisors, &max_val)) {
+		log_line("The lcm of the divisors doesn't fit in 64 bits");
+		return;
+	}
+	for (auto& monkey : monkeys) {
+		monkey.operation.val_mod = monkey.operation.val % max_val;
+	}
+
+	result->t_parsed = Bench_clock::now();
+
+	// Without division (part 2) values are kept mod the lcm of the divisors, so an item has a finite
+	//	number of states and its round-start states end in a cycle. Each item finds its cycle with Brent's
+	//	algorithm and extrapolates its inspection counts, so the cost depends on the cycle length, not on
+	//	num_rounds. Dividing doesn't commute with the reduction, so part 1 runs on exact values instead.
+	//	Part 1 values that outgrow Exact_worry are reported as an error rather than continued on big
+	//	integers: an item squared every round doubles its size each round.
+	// Products past 64 bits are returned in big_result instead. has_overflow is set on a part 1 overflow.
+	auto simulate = [&monkeys, max_val](long long num_rounds, long long val_div, std::string* big_result, bool* has_overflow) {
+		int num_monkeys = (int)monkeys.size();
+		bool is_exact = val_div != 1;
+		std::vector<Item_state> items = {};
+		for (int idx_monkey = 0; idx_monkey < num_monkeys; idx_monkey++) {
+			for (auto val : monkeys[idx_monkey].items) {
+				items.push_back({ idx_monkey, is_exact ? val : val % max_val });
+			}
+		}
+
+		// An item thrown to a later monkey is inspected again in the same round. Each inspection adds weight
+		//	to num_inspections, so one pass over a cycle can count for all its repetitions.
+		auto run_round = [&](Item_state state, long long* num_inspections, long long weight) {
+			while (true) {
+				auto& cur_monkey = monkeys[state.idx_monkey];
+				if (num_inspections != nullptr) {
+					num_inspections[state.idx_monkey] += weight;
+				}
+				long long val_new = cur_monkey.operation.apply_mod(state.val, max_val);
+				int idx_target_monkey = val_new % cur_monkey.test_divisor == 0 ? cur_monkey.idx_monkey_on_true : cur_monkey.idx_monkey_on_false;
+				bool is_next_round = idx_target_monkey <= state.idx_monkey;
+				state = { idx_target_monkey, val_new };
+				if (is_next_round) {
+					return state;
+				}
+			}
+		};
+
+		auto run_rounds = [&](Item_state state, long long cnt, long long* num_inspections, long long weight = 1) {
+			for (long long idx_round = 0; idx_round < cnt; idx_round++) {
+				state = run_round(state, num_inspections, weight);
+			}
+			return state;
+		};
+
+		// False on overflow
+		auto run_rounds_exact = [&](Item_state start, long long cnt, long long* num_inspections) {
+			int idx_monkey = start.idx_monkey;
+			Exact_worry val = start.val;
+			for (long long idx_round = 0; idx_round < cnt; idx_round++) {
+				while (true) {
+					auto& cur_monkey = monkeys[idx_monkey];
+					num_inspections[idx_monkey]++;
+					Exact_worry val_new = 0;
+					if (!cur_monkey.operation.apply_exact(val, &val_new)) {
+						return false;
+					}
+					val = val_new / val_div;
+					int idx_target_monkey = val % cur_monkey.test_divisor == 0 ? cur_monkey.idx_monkey_on_true : cur_monkey.idx_monkey_on_false;
+					bool is_next_round = idx_target_monkey <= idx_monkey;
+					idx_monkey = idx_target_monkey;
+					if (is_next_round) {
+						break;
+					}
+				}
+			}
+			return true;
+		};
+
+		std::atomic<bool> item_overflow = false;
+
+		// Adds the inspections of one item to num_inspections
+		auto simulate_item = [&](Item_state start, long long* num_inspections) {
+			if (is_exact) {
+				if (!run_rounds_exact(start, num_rounds, num_inspections)) {
+					item_overflow = true;
+				}
+				return;
+			}
+
+			// Brent: cycle_len is the smallest power of two window that contains the cycle. Gives up once
+			//	it has taken more steps than simulating all rounds would.
+			long long cycle_len = 1;
+			long long power = 1;
+			long long num_steps = 1;
+			auto tortoise = start;
+			auto hare = run_round(start, nullptr, 1);
+			while (!(tortoise == hare) && num_steps <= num_rounds) {
+				if (power == cycle_len) {
+					tortoise = hare;
+					power *= 2;
+					cycle_len = 0;
+				}
+				hare = run_round(hare, nullptr, 1);
+				cycle_len++;
+				num_steps++;
+			}
+			if (num_steps > num_rounds) {
+				run_rounds(start, num_rounds, num_inspections);
+				return;
+			}
+
+			long long cycle_start = 0;
+			tortoise = start;
+			hare = run_rounds(start, cycle_len, nullptr);
+			while (!(tortoise == hare)) {
+				tortoise = run_round(tortoise, nullptr, 1);
+				hare = run_round(hare, nullptr, 1);
+				cycle_start++;
+			}
+
+			if (cycle_start + cycle_len >= num_rounds) {
+				run_rounds(start, num_rounds, num_inspections);
+				return;
+			}
+
+			auto state = run_rounds(start, cycle_start, num_inspections);
+			long long num_cycles = (num_rounds - cycle_start) / cycle_len;
+			run_rounds(state, cycle_len, num_inspections, num_cycles);
+			run_rounds(state, (num_rounds - cycle_start) % cycle_len, num_inspections);
+			};
+
+		// Counts are kept per chunk of items, not per item. A few chunks per thread even out items
+		//	with long cycles.
+		size_t num_chunks = std::clamp<size_t>(items.size(), 1, 4 * get_thread_budget());
+		std::vector<std::vector<long long>> chunk_inspections(num_chunks);
+
+		parallel_for(num_chunks, [&](size_t idx_chunk) {
+			auto& num_inspections = chunk_inspections[idx_chunk];
+			num_inspections.assign(num_monkeys, 0);
+			for (size_t idx_item = items.size() * idx_chunk / num_chunks; idx_item < items.size() * (idx_chunk + 1) / num_chunks; idx_item++) {
+				simulate_item(items[idx_item], num_inspections.data());
+			}
+			});
+
+		if (item_overflow) {
+			*has_overflow = true;
+			return 0ll;
+		}
+
+		std::vector<long long> num_inspections(num_monkeys, 0);
+
+		for (auto& counts : chunk_inspections) {
+			for (int idx_monkey = 0; idx_monkey < num_monkeys; idx_monkey++) {
+				num_inspections[idx_monkey] += counts[idx_monkey];
+			}
+		}
+
+		if (num_monkeys < 2) {
+			return 0ll;
+		}
+
+		std::sort(num_inspections.begin(), num_inspections.end());
+
+		long long monkey_business = 0;
+		if (!checked_mul(*(num_inspections.end() - 1), *(num_inspections.end() - 2), &monkey_business)) {
+			*big_result = mul_to_string(*(num_inspections.end() - 1), *(num_inspections.end() - 2));
+			return 0ll;
+		}
+
+		return monkey_business;
+		};
+
+	bool has_overflow = false;
+	result->pt1 = simulate(20, 3, &result->pt1_string, &has_overflow);
+	if (has_overflow) {
+		log_line(std::format("Part 1 worry values don't fit in {} bits", sizeof(Exact_worry) * 8));
+		result->pt1_string = "overflow";
+		result->failed = true;
+	}
+	result->t_pt1 = Bench_clock::now();
+	result->pt2 = simulate(10000, 1, &result->pt2_string, &has_overflow);
+}
+
+void aoc12(const Input_file& lines, Task_result* result) {
+	if (lines.empty() || lines[0].empty()) {
+		return;
+	}
+
+	auto num_rows = lines.size();
+	auto num_cols = lines[0].size();
+
+	Grid<char> grid(num_rows, num_cols, 1, 0);
+
+	size_t idx_start = 0;
+	size_t idx_end = 0;
+
+	for (size_t idx_row = 0; idx_row < num_rows; idx_row++) {
+		for (size_t idx_col = 0; idx_col < num_cols && idx_col < lines[idx_row].size(); idx_col++) {
+			auto cur_char = lines[idx_row][idx_col];
+			if (cur_char == 'S') {
+				cur_char = 'a';
+				idx_start = grid.idx(idx_row, idx_col);
+			}
+			if (cur_char == 'E') {
+				cur_char = 'z';
+				idx_end = grid.idx(idx_row, idx_col);
+			}
+			grid.at(idx_row, idx_col) = cur_char;
+		}
+	}
+
+	result->t_parsed = Bench_clock::now();
+
+	auto cond = [](char cur_val, char check_val) {
+		return (check_val <= cur_val || (check_val - cur_val) == 1);
+		};
+	auto num_steps = grid_bfs(grid, { idx_start }, cond);
+
+	result->pt1 = num_steps[idx_end];
+	result->t_pt1 = Bench_clock::now();
+
+	// Walking backwards from E with the inverted climb condition gives the distance from every cell
+	//	to E in one pass, so the best start is the 'a' cell with the smallest distance.
+	auto cond_reverse = [](char cur_val, char check_val) {
+		return cur_val - check_val <= 1;
+		};
+	auto num_steps_to_end = grid_bfs(grid, { idx_end }, cond_reverse);
+
+	uint32_t cur_min_steps = grid_bfs_unreached;
+	for (size_t idx_cell = 0; idx_cell < grid.cells.size(); idx_cell++) {
+		if (grid.cells[idx_cell] == 'a' && num_steps_to_end[idx_cell] < cur_min_steps) {
+			cur_min_steps = num_steps_to_end[idx_cell];
+		}
+	}
+	result->pt2 = cur_min_steps;
+}
+
+using Aoc_fn = void (*)(const Input_file&, Task_result*);
+
+const std::map<int, Aoc_fn>& aoc_fns() {
+	static const std::map<int, Aoc_fn> fns = {
+		{1,		aoc01},
+		{2,		aoc02},
+		{3,		aoc03},
+		{4,		aoc04},
+		{5,		aoc05},
+		{6,		aoc06},
+		{7,		aoc07},
+		{8,		aoc08},
+		{9,		aoc09},
+		{10,	aoc10},
+		{11,	aoc11},
+		{12,	aoc12},
+		//{13,	aoc13},
+		//{14,	aoc14},
+		//{15,	aoc15},
+		//{16,	aoc16},
+		//{17,	aoc17},
+		//{18,	aoc18},
+		//{19,	aoc19},
+		//{20,	aoc20},
+		//{21,	aoc21},
+		//{22,	aoc22},
+		//{23,	aoc23},
+		//{24,	aoc24},
+		//{25,	aoc25}
+	};
+
+	return fns;
+}
+
+// Incremental solver. feed() gets the input in consecutive chunks that can end anywhere, finish() is
+//	called once after the last chunk.
+struct Stream_solver {
+	std::function<void(std::string_view chunk)> feed;
+	std::function<void(Task_result*)> finish;
+};
+
+// Streaming solver for days whose state struct consumes one line at a time
+template <typename State>
+Stream_solver make_line_stream_solver() {
+	auto state = std::make_shared<State>();
+	auto splitter = std::make_shared<Line_splitter>();
+
+	return {
+		[state, splitter](std::string_view chunk) {
+			splitter->feed(chunk, [&state](std::string_view line) { state->add_line(line); });
+		},
+		[state, splitter](Task_result* result) {
+			splitter->finish([&state](std::string_view line) { state->add_line(line); });
+			state->finish(result);
+		}
+	};
+}
+
+// Day 6 inputs can be a single huge line, so characters are fed as they come instead of per line
+Stream_solver make_aoc06_stream_solver() {
+	auto state = std::make_shared<Aoc06_state>();
+	auto has_partial_line = std::make_shared<bool>(false);
+
+	return {
+		[state, has_partial_line](std::string_view chunk) {
+			while (!chunk.empty()) {
+				auto idx = chunk.find('\n');
+				if (idx == std::string_view::npos) {
+					state->add_chars(chunk);
+					*has_partial_line = true;
+					return;
+				}
+				state->add_chars(chunk.substr(0, idx));
+				state->end_line();
+				*has_partial_line = false;
+				chunk.remove_prefix(idx + 1);
+			}
+		},
+		[state, has_partial_line](Task_result* result) {
+			if (*has_partial_line) {
+				state->end_line();
+			}
+			state->finish(result);
+		}
+	};
+}
+
+const std::map<int, std::function<Stream_solver()>>& stream_fns() {
+	static const std::map<int, std::function<Stream_solver()>> fns = {
+		{1,		make_line_stream_solver<Aoc01_state>},
+		{2,		make_line_stream_solver<Aoc02_state>},
+		{3,		make_line_stream_solver<Aoc03_state>},
+		{4,		make_line_stream_solver<Aoc04_state>},
+		{6,		make_aoc06_stream_solver},
+		{7,		make_line_stream_solver<Aoc07_state>},
+		{9,		make_line_stream_solver<Aoc09_state>},
+		{10,	make_line_stream_solver<Aoc10_state>},
+	};
+
+	return fns;
+}
+
+// Synthetic inputs for scaling benchmarks. The generators write valid puzzle inputs of arbitrary size,
+//	and the same seed always gives the same input (mt19937_64 output is fixed by the standard).
+struct Gen_rng {
+	std::mt19937_64 engine;
+
+	// Uniform in [lo, hi_incl]
+	long long range(long long lo, long long hi_incl) {
+		return lo + (long long)(engine() % (unsigned long long)(hi_incl - lo + 1));
+	}
+
+	template <typename T>
+	void shuffle(std::vector<T>& vals) {
+		for (size_t i = vals.size(); i > 1; i--) {
+			std::swap(vals[i - 1], vals[(size_t)range(0, (long long)i - 1)]);
+		}
+	}
+};
+
+// size = number of elves
+void gen01(long long size, Gen_rng& rng, std::ostream& out) {
+	for (long long idx_elf = 0; idx_elf < size; idx_elf++) {
+		auto num_items = rng.range(1, 10);
+		for (long long i = 0; i < num_items; i++) {
+			out << rng.range(1'000, 60'000) << '\n';
+		}
+		// Also after the last elf, which the solver only counts on an empty line
+		out << '\n';
+	}
+}
+
+// size = number of rounds
+void gen02(long long size, Gen_rng& rng, std::ostream& out) {
+	std::string line = "A X\n";
+
+	for (long long i = 0; i < size; i++) {
+		line[0] = (char)('A' + rng.range(0, 2));
+		line[2] = (char)('X' + rng.range(0, 2));
+		out << line;
+	}
+}
+
+// size = number of groups of three rucksacks
+void gen03(long long size, Gen_rng& rng, std::ostream& out) {
+	auto prio_to_char = [](long long prio) {
+		return (char)(prio <= 26 ? 'a' + prio - 1 : 'A' + prio - 27);
+		};
+
+	std::vector<long long> prios(52);
+	std::iota(prios.begin(), prios.end(), 1);
+
+	for (long long idx_group = 0; idx_group < size; idx_group++) {
+		// The badge is the only item in all three rucksacks. The other items are split into three
+		//	disjoint sets of 17, one per rucksack: one shared item, 8 left-only and 8 right-only.
+		rng.shuffle(prios);
+		auto badge = prios[51];
+		auto badge_left = rng.range(0, 1) == 0;
+
+		for (int idx_rucksack = 0; idx_rucksack < 3; idx_rucksack++) {
+			auto item_set = prios.begin() + idx_rucksack * 17;
+			auto shared_item = item_set[0];
+			auto half_size = rng.range(2, 16);
+			std::vector<char> halves[2] = {};
+
+			for (int idx_half = 0; idx_half < 2; idx_half++) {
+				auto& half = halves[idx_half];
+				half.push_back(prio_to_char(shared_item));
+				if (badge_left == (idx_half == 0)) {
+					half.push_back(prio_to_char(badge));
+				}
+				while ((long long)half.size() < half_size) {
+					half.push_back(prio_to_char(item_set[1 + idx_half * 8 + rng.range(0, 7)]));
+				}
+				rng.shuffle(half);
+				out.write(half.data(), half.size());
+			}
+			out << '\n';
+		}
+	}
+}
+
+// size = number of pairs
+void gen04(long long size, Gen_rng& rng, std::ostream& out) {
+	for (long long i = 0; i < size; i++) {
+		auto start_1 = rng.range(1, 99);
+		auto start_2 = rng.range(1, 99);
+		out << start_1 << '-' << rng.range(start_1, 99) << ',' << start_2 << '-' << rng.range(start_2, 99) << '\n';
+	}
+}
+
+// size = number of moves. Nine stacks start with 2 + size / 100 crates each.
+void gen05(long long size, Gen_rng& rng, std::ostream& out) {
+	int num_stacks = 9;
+	auto start_height = 2 + size / 100;
+	std::vector<long long> heights(num_stacks, start_height);
+
+	for (long long row = start_height - 1; row >= 0; row--) {
+		std::string line = {};
+		for (int idx_stack = 0; idx_stack < num_stacks; idx_stack++) {
+			line += std::format("{}[{}]", idx_stack == 0 ? "" : " ", (char)('A' + rng.range(0, 25)));
+		}
+		out << line << '\n';
+	}
+	for (int idx_stack = 0; idx_stack < num_stacks; idx_stack++) {
+		out << std::format("{} {} ", idx_stack == 0 ? "" : " ", idx_stack + 1);
+	}
+	out << "\n\n";
+
+	// Every stack keeps at least one crate, so the top crates are always defined
+	for (long long i = 0; i < size; i++) {
+		long long idx_from = 0;
+		do {
+			idx_from = rng.range(0, num_stacks - 1);
+		} while (heights[idx_from] < 2);
+		auto idx_to = (idx_from + rng.range(1, num_stacks - 1)) % num_stacks;
+		auto cnt = rng.range(1, heights[idx_from] - 1);
+		heights[idx_from] -= cnt;
+		heights[idx_to] += cnt;
+		out << std::format("move {} from {} to {}\n", cnt, idx_from + 1, idx_to + 1);
+	}
+}
+
+// size = number of characters. Only 13 letters are used until the last 14 characters, which are
+//	distinct, so the start-of-message marker ends up at the very end.
+void gen06(long long size, Gen_rng& rng, std::ostream& out) {
+	size = std::max(size, 14ll);
+	std::string buf = {};
+
+	for (long long i = 0; i < size - 14; i++) {
+		buf += (char)('a' + rng.range(0, 12));
+		if (buf.size() == 1 << 16) {
+			out << buf;
+			buf.clear();
+		}
+	}
+
+	std::vector<char> marker(26);
+	std::iota(marker.begin(), marker.end(), 'a');
+	rng.shuffle(marker);
+	buf.append(marker.data(), 14);
+	out << buf << '\n';
+}
+
+// size = number of directories. File sizes are scaled so 45M-65M of the 70M disk is used, so part 2
+//	always has to delete something and can. Past a few million files the 1 byte minimum adds up.
+void gen07(long long size, Gen_rng& rng, std::ostream& out) {
+	size = std::max(size, 1ll);
+	std::vector<std::vector<long long>> children(size);
+
+	// Mix of deep chains and wide fan-out
+	for (long long idx_dir = 1; idx_dir < size; idx_dir++) {
+		auto idx_parent = rng.range(0, 1) == 0 ? idx_dir - 1 : rng.range(0, idx_dir - 1);
+		children[idx_parent].push_back(idx_dir);
+	}
+
+	// Random weights first, then each file gets its share of the total. Cumulative rounding keeps the
+	//	sum at the total.
+	std::vector<std::vector<long long>> file_sizes(size);
+	long long sum_weights = 0;
+	for (auto& sizes : file_sizes) {
+		auto num_files = rng.range(0, 4);
+		for (long long i = 0; i < num_files; i++) {
+			sizes.push_back(rng.range(1, 1000));
+			sum_weights += sizes.back();
+		}
+	}
+	if (sum_weights == 0) {
+		file_sizes[0].push_back(1);
+		sum_weights = 1;
+	}
+	double total_size = (double)rng.range(45'000'000, 65'000'000);
+	long long cum_weights = 0;
+	long long cum_size = 0;
+	for (auto& sizes : file_sizes) {
+		for (auto& file_size : sizes) {
+			cum_weights += file_size;
+			long long cum_size_new = (long long)((double)cum_weights * total_size / (double)sum_weights);
+			file_size = std::max(cum_size_new - cum_size, 1ll);
+			cum_size = cum_size_new;
+		}
+	}
+
+	struct Visit {
+		long long idx_dir;
+		size_t idx_next_child;
+	};
+
+	auto list_dir = [&](long long idx_dir) {
+		out << "$ ls\n";
+		for (auto idx_child : children[idx_dir]) {
+			out << "dir d" << idx_child << '\n';
+		}
+		for (size_t i = 0; i < file_sizes[idx_dir].size(); i++) {
+			out << file_sizes[idx_dir][i] << " f" << i << ".txt\n";
+		}
+		};
+
+	out << "$ cd /\n";
+	list_dir(0);
+	std::vector<Visit> path = { { 0, 0 } };
+
+	while (!path.empty()) {
+		auto& cur = path.back();
+		if (cur.idx_next_child == children[cur.idx_dir].size()) {
+			path.pop_back();
+			if (!path.empty()) {
+				out << "$ cd ..\n";
+			}
+			continue;
+		}
+		auto idx_child = children[cur.idx_dir][cur.idx_next_child++];
+		out << "$ cd d" << idx_child << '\n';
+		list_dir(idx_child);
+		path.push_back({ idx_child, 0 });
+	}
+}
+
+// size = side of the square tree grid
+void gen08(long long size, Gen_rng& rng, std::ostream& out) {
+	std::string line((size_t)size + 1, '\n');
+
+	for (long long row = 0; row < size; row++) {
+		for (long long col = 0; col < size; col++) {
+			line[col] = (char)('0' + rng.range(0, 9));
+		}
+		out << line;
+	}
+}
+
+// size = number of moves
+void gen09(long long size, Gen_rng& rng, std::ostream& out) {
+	const char dirs[] = { 'U', 'D', 'L', 'R' };
+
+	for (long long i = 0; i < size; i++) {
+		out << dirs[rng.range(0, 3)] << ' ' << rng.range(1, 20) << '\n';
+	}
+}
+
+// size = number of instructions
+void gen10(long long size, Gen_rng& rng, std::ostream& out) {
+	for (long long i = 0; i < size; i++) {
+		if (rng.range(0, 2) == 0) {
+			out << "noop\n";
+			continue;
+		}
+		out << "addx " << rng.range(-10, 10) << '\n';
+	}
+}
+
+// size = number of monkeys, at least 3. Every squaring doubles the size of the exact part 1 worry
+//	values, so only one monkey squares and no monkey throws to it: each item is squared at most once,
+//	and only if it starts there.
+void gen11(long long size, Gen_rng& rng, std::ostream& out) {
+	const long long divisors[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23 };
+	size = std::max(size, 3ll);
+	auto idx_square_monkey = rng.range(0, size - 1);
+
+	for (long long idx_monkey = 0; idx_monkey < size; idx_monkey++) {
+		out << (idx_monkey == 0 ? "" : "\n") << "Monkey " << idx_monkey << ":\n";
+
+		out << "  Starting items: ";
+		auto num_items = rng.range(1, 6);
+		for (long long i = 0; i < num_items; i++) {
+			out << (i == 0 ? "" : ", ") << rng.range(50, 99);
+		}
+		out << '\n';
+
+		if (idx_monkey == idx_square_monkey) {
+			out << "  Operation: new = old * old\n";
+		}
+		else if (rng.range(0, 2) == 0) {
+			out << "  Operation: new = old * " << rng.range(2, 19) << '\n';
+		}
+		else {
+			out << "  Operation: new = old + " << rng.range(1, 8) << '\n';
+		}
+
+		out << "  Test: divisible by " << divisors[rng.range(0, 8)] << '\n';
+
+		// Targets are neither this monkey nor the squaring one, and differ when there are two to pick from
+		long long num_targets = size - (idx_monkey == idx_square_monkey ? 1 : 2);
+		auto is_target = [&](long long idx_target) {
+			return idx_target != idx_monkey && idx_target != idx_square_monkey;
+			};
+		auto idx_on_true = idx_monkey;
+		while (!is_target(idx_on_true)) {
+			idx_on_true = rng.range(0, size - 1);
+		}
+		auto idx_on_false = idx_monkey;
+		while (!is_target(idx_on_false) || (num_targets > 1 && idx_on_false == idx_on_true)) {
+			idx_on_false = rng.range(0, size - 1);
+		}
+		out << "    If true: throw to monkey " << idx_on_true << '\n';
+		out << "    If false: throw to monkey " << idx_on_false << '\n';
+	}
+}
+
+// size = side of the square height map, at least 26. Heights rise one letter per column band, with
+//	random dips. One row has no dips, so E is always reachable from S.
+void gen12(long long size, Gen_rng& rng, std::ostream& out) {
+	size = std::max(size, 26ll);
+	auto row_path = rng.range(0, size - 1);
+	std::string line((size_t)size + 1, '\n');
+
+	for (long long row = 0; row < size; row++) {
+		for (long long col = 0; col < size; col++) {
+			auto height = std::min(25ll, col * 26 / size);
+			if (row != row_path && rng.range(0, 9) < 3) {
+				height = rng.range(0, height);
+			}
+			line[col] = (char)('a' + height);
+		}
+		if (row == row_path) {
+			line[0] = 'S';
+			line[size - 1] = 'E';
+		}
+		out << line;
+	}
+}
+
+using Gen_fn = void (*)(long long, Gen_rng&, std::ostream&);
+
+const std::map<int, Gen_fn>& gen_fns() {
+	static const std::map<int, Gen_fn> fns = {
+		{1,		gen01},
+		{2,		gen02},
+		{3,		gen03},
+		{4,		gen04},
+		{5,		gen05},
+		{6,		gen06},
+		{7,		gen07},
+		{8,		gen08},
+		{9,		gen09},
+		{10,	gen10},
+		{11,	gen11},
+		{12,	gen12},
+	};
+
+	return fns;
+}
 
-	int num_lines = (int)lines.size();
-	int num_monkeys = (num_lines + 1) / 7;
-	std::vector<Monkey> monkeys(num_monkeys);
-	int idx_cur_monkey = 0;
+bool generate_input(int id, long long size, unsigned long long seed, std::ostream& out) {
+	auto& fns = gen_fns();
 
-	for (int idx_line = 0; idx_line < num_lines; idx_line++) {
-		auto cur_line_copy = lines[idx_line];
-		if ((idx_line + 1) % 7 == 0) {
-			idx_cur_monkey++;
-		}
+	if (fns.count(id) == 0) {
+		std::cout << "Could not find generator for ID " << id << std::endl;
+		return false;
+	}
 
-		auto& cur_monkey = monkeys[idx_cur_monkey];
-		int idx_monkey_line = idx_line % 7;
+	Gen_rng rng = { std::mt19937_64(seed) };
+	fns.at(id)(size, rng, out);
 
-		Line_type line_type = Line_type::None;
-		switch (idx_monkey_line) {
-		case 0:line_type = Line_type::Id;			break;
-		case 1:line_type = Line_type::Items;		break;
-		case 2:line_type = Line_type::Operation;	break;
-		case 3:line_type = Line_type::Test_divisor; break;
-		case 4:line_type = Line_type::On_true;		break;
-		case 5:line_type = Line_type::On_false;		break;
+	return (bool)out;
+}
+
+struct Run_options {
+	std::vector<int> ids;
+	bool use_test_data;
+	bool use_real_data;
+	// Run on this file instead of the test and real inputs
+	std::string fn_input;
+	// Run on generated inputs of these sizes instead of the test and real inputs
+	std::vector<long long> gen_sizes;
+	unsigned long long gen_seed;
+	// Only write a generated input for the first day, don't run anything
+	bool generate_only;
+	// Threads for the whole run, shared by concurrent days and the parallel work inside them.
+	//	0 means one thread per core.
+	size_t num_threads;
+	// Use the streaming solvers, for days that have one
+	bool use_stream;
+	size_t stream_chunk_size;
+	// Benchmark mode is enabled when num_iterations > 0
+	int num_iterations;
+	int num_warmup;
+	// Benchmark results or generated input
+	std::string fn_out;
+};
+
+struct Input_source {
+	std::string name;
+	std::string fn;
+	// Generated inputs are removed when done
+	bool is_generated;
+};
+
+bool get_input_file_name(std::string* fn_absolute, int id, bool use_test_data) {
+	std::string fn_relative = std::format("aoc{:02}-{}.txt", id, use_test_data ? "test" : "real");
+
+	if (!get_data_file_name(fn_absolute, fn_relative)) {
+		std::cout << "Could not get data file name" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool get_inputs(int id, const Run_options& options, std::vector<Input_source>* inputs) {
+	if (!options.fn_input.empty()) {
+		inputs->push_back({ "file", options.fn_input, false });
+		return true;
+	}
+
+	// The temp directory is shared, so the name has the seed and the process ID in it
+	for (auto size : options.gen_sizes) {
+		auto fn_gen = std::format("aoc{:02}-gen-{}-seed-{}-pid-{}.txt", id, size, options.gen_seed, (long long)AOC_GETPID());
+		auto fn = std::filesystem::temp_directory_path() / fn_gen;
+		std::ofstream outfile(fn, std::ios::binary);
+		if (!outfile || !generate_input(id, size, options.gen_seed, outfile)) {
+			std::cout << "Could not generate input " << fn.string() << std::endl;
+			return false;
 		}
+		inputs->push_back({ std::format("gen-{}", size), fn.string(), true });
+	}
+	if (!options.gen_sizes.empty()) {
+		return true;
+	}
 
-		if (line_type == Line_type::Id) {
-			cur_monkey.id = std::atoi(string_remove_char(string_split(cur_line_copy, " ")[1], ':').c_str());
+	for (int i = 0; i < 2; i++) {
+		bool use_test_data = i == 0;
+		if ((use_test_data && !options.use_test_data) || (!use_test_data && !options.use_real_data)) {
+			continue;
 		}
-		if (line_type == Line_type::Items) {
-			auto pts = string_split(cur_line_copy, ": ");
-			auto nums = string_split(pts[1], ", ");
-			std::for_each(nums.begin(), nums.end(), [&](std::string s) {cur_monkey.items.push_back(std::atoi(s.c_str())); });
+		std::string fn_absolute = {};
+		if (!get_input_file_name(&fn_absolute, id, use_test_data)) {
+			return false;
 		}
+		inputs->push_back({ use_test_data ? "test" : "real", fn_absolute, false });
+	}
 
-		if (line_type == Line_type::Operation) {
-			auto pts = string_split(cur_line_copy, "Operation: ");
-			auto eq = string_split(pts[1], "= ")[1];
-			auto split_add = string_split(eq, " + ");
-			auto split_mult = string_split(eq, " * ");
-			std::sort(split_add.begin(), split_add.end());
-			std::sort(split_mult.begin(), split_mult.end());
-			if (split_add.size() == 2) {
-				bool both_old = split_add[0] == "old";
-				if (both_old) {
-					// Both parts are 'old'
-					cur_monkey.operation = [](long long old) { return old + old; };
-				}
-				if (!both_old) {
-					cur_monkey.operation = [=](long long old) { return std::atoll(split_add[0].c_str()) + old; };
-				}
-			}
-			if (split_mult.size() == 2) {
-				bool both_old = split_mult[0] == "old";
-				if (both_old) {
-					// Both parts are 'old'
-					cur_monkey.operation = [](long long old) { return old * old; };
-				}
-				if (!both_old) {
-					cur_monkey.operation = [=](long long old) { return std::atoll(split_mult[0].c_str()) * old; };
-				}
-			}
-		}
+	return true;
+}
 
-		if (line_type == Line_type::Test_divisor) {
-			auto pts = string_split(cur_line_copy, "divisible by ");
-			cur_monkey.test_divisor = std::atoi(pts[1].c_str());
+void remove_generated_inputs(const std::vector<Input_source>& inputs) {
+	for (auto& input : inputs) {
+		if (input.is_generated) {
+			std::error_code ec = {};
+			std::filesystem::remove(input.fn, ec);
 		}
+	}
+}
 
-		if (line_type == Line_type::On_true) {
-			auto pts = string_split(cur_line_copy, "monkey ");
-			cur_monkey.idx_monkey_on_true = std::atoi(pts[1].c_str());
+std::string format_result(int id, const std::string& input_name, const Task_result& result) {
+	std::string pt1 = std::to_string(result.pt1);
+	std::string pt2 = std::to_string(result.pt2);
+	if (!result.pt1_string.empty()) {
+		pt1 = result.pt1_string;
+	}
+	if (!result.pt2_string.empty()) {
+		pt2 = result.pt2_string;
+	}
+
+	return std::format("AOC-{:02} ({}):\n  pt1: {}\n  pt2: {}", id, input_name, pt1, pt2);
+}
+
+// Runs on a worker thread, so all output, including errors, goes to output for the caller to print
+bool run_with_file(int id, const Input_source& input, const Run_options& options, std::string* output) {
+	Task_result result = {};
+	auto& stream_solvers = stream_fns();
+	bool ok = true;
+
+	auto prev_log = solver_log;
+	solver_log = &result.log;
+	if (options.use_stream && stream_solvers.count(id) > 0) {
+		auto solver = stream_solvers.at(id)();
+		ok = stream_file(input.fn, options.stream_chunk_size, solver.feed);
+		if (ok) {
+			solver.finish(&result);
+			ok = !result.failed;
+		}
+		else {
+			log_line(std::format("Could not stream file {}", input.fn));
+		}
+	}
+	else {
+		Input_file lines = {};
+		ok = lines.open(input.fn);
+		if (ok) {
+			aoc_fns().at(id)(lines, &result);
+			ok = !result.failed;
 		}
+		else {
+			log_line(std::format("Could not read input file {}", input.fn));
+		}
+	}
+	solver_log = prev_log;
 
-		if (line_type == Line_type::On_false) {
-			auto pts = string_split(cur_line_copy, "monkey ");
-			cur_monkey.idx_monkey_on_false = std::atoi(pts[1].c_str());
+	*output = result.log;
+	if (ok || result.failed) {
+		*output += format_result(id, input.name, result) + "\n";
+	}
+
+	return ok;
+}
+
+// Runs all inputs of all requested days concurrently. Output is printed in request order.
+bool aoc(const Run_options& options) {
+	struct Run_task {
+		int id;
+		Input_source input;
+		bool ok;
+		std::string output;
+	};
+
+	auto& fns = aoc_fns();
+	std::vector<Run_task> tasks = {};
+	std::vector<Input_source> all_inputs = {};
+	bool ok = true;
+
+	for (auto id : options.ids) {
+		if (fns.count(id) == 0) {
+			std::cout << "Could not find implementation for ID " << id << std::endl;
+			ok = false;
+			continue;
 		}
+		std::vector<Input_source> inputs = {};
+		if (get_inputs(id, options, &inputs)) {
+			for (auto& input : inputs) {
+				tasks.push_back({ id, input, false, {} });
+			}
+		}
+		else {
+			ok = false;
+		}
+		all_inputs.insert(all_inputs.end(), inputs.begin(), inputs.end());
 	}
 
-	int tot_items = 0;
+	parallel_for(tasks.size(), [&tasks, &options](size_t idx_task) {
+		auto& task = tasks[idx_task];
+		task.ok = run_with_file(task.id, task.input, options, &task.output);
+		});
 
-	for (auto& monkey : monkeys) {
-		tot_items += (int)monkey.items.size();
+	for (auto& task : tasks) {
+		std::cout << task.output << std::flush;
+		ok = ok && task.ok;
 	}
 
-	for (auto& monkey : monkeys) {
-		monkey.num_items = (int)monkey.items.size();
-		monkey.items.resize(tot_items);
+	remove_generated_inputs(all_inputs);
+
+	return ok;
+}
+
+struct Bench_row {
+	int id;
+	std::string input;
+	std::string phase;
+	int num_iterations;
+	long long min_ns;
+	long long median_ns;
+	long long p99_ns;
+};
+
+// Nearest-rank percentile. Expects the values to be sorted.
+long long percentile(const std::vector<long long>& vals, double p) {
+	if (vals.empty()) {
+		return 0;
 	}
 
-	auto simulate = [](std::vector<Monkey> monkeys, int tot_items, int num_rounds, long long val_div) {
-		long long max_val = 1;
-		int num_monkeys = (int)monkeys.size();
-		for (auto& monkey : monkeys) {
-			max_val *= monkey.test_divisor;
+	auto rank = (size_t)std::ceil(p * vals.size());
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	return vals[std::min(rank, vals.size()) - 1];
+}
+
+bool bench_with_file(int id, const Input_source& input, const Run_options& options, std::vector<Bench_row>* rows) {
+	auto& fns = aoc_fns();
+	std::vector<std::string> phases = { "read", "parse", "pt1", "pt2", "solve", "total" };
+	std::vector<std::vector<long long>> phase_ns(phases.size());
+	auto to_ns = [](Bench_clock::duration d) {
+		return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+		};
+
+	for (int idx_iteration = 0; idx_iteration < options.num_warmup + options.num_iterations; idx_iteration++) {
+		auto t_start = Bench_clock::now();
+		Input_file lines = {};
+		if (!lines.open(input.fn)) {
+			std::cout << "Could not read input file " << input.fn << std::endl;
+			return false;
+		}
+		auto t_read = Bench_clock::now();
+		Task_result result = {};
+		fns.at(id)(lines, &result);
+		auto t_end = Bench_clock::now();
+		if (result.failed) {
+			return false;
 		}
 
-		for (int idx_round = 0; idx_round < num_rounds; idx_round++) {
-			for (int idx_monkey = 0; idx_monkey < num_monkeys; idx_monkey++) {
-				auto& cur_monkey = monkeys[idx_monkey];
-				int idx_start = cur_monkey.idx_start_items;
-				int idx_end_exclusive = idx_start + cur_monkey.num_items;
-				for (int idx_item = idx_start; idx_item < idx_end_exclusive; idx_item++) {
-					cur_monkey.num_inspections++;
-					auto val_old = cur_monkey.items[idx_item % tot_items];
-					auto val_new = cur_monkey.operation(val_old);
-					val_new = val_new % max_val;
-					val_new /= val_div;
-					int idx_target_monkey = 0;
-					int test_true = (val_new % cur_monkey.test_divisor) == 0;
-					if (test_true) {
-						idx_target_monkey = cur_monkey.idx_monkey_on_true;
-					}
-					if (!test_true) {
-						idx_target_monkey = cur_monkey.idx_monkey_on_false;
-					}
-					auto& target_monkey = monkeys[idx_target_monkey];
-					target_monkey.items[(target_monkey.idx_start_items + target_monkey.num_items) % tot_items] = val_new;
-					target_monkey.num_items++;
-					cur_monkey.num_items--;
-					cur_monkey.idx_start_items = (cur_monkey.idx_start_items + 1) % tot_items;
-				}
-			}
+		if (idx_iteration < options.num_warmup) {
+			continue;
 		}
 
-		std::vector<long long> num_inspections(num_monkeys);
+		// Phases without marks are not measured, rather than reported as zero
+		bool has_parsed = result.t_parsed != Bench_clock::time_point{};
+		bool has_pt1 = result.t_pt1 != Bench_clock::time_point{};
+		auto t_parsed = has_parsed ? result.t_parsed : t_read;
 
-		for (int idx_monkey = 0; idx_monkey < num_monkeys; idx_monkey++) {
-			num_inspections[idx_monkey] = monkeys[idx_monkey].num_inspections;
+		phase_ns[0].push_back(to_ns(t_read - t_start));
+		if (has_parsed) {
+			phase_ns[1].push_back(to_ns(t_parsed - t_read));
 		}
+		if (has_pt1) {
+			phase_ns[2].push_back(to_ns(result.t_pt1 - t_parsed));
+			phase_ns[3].push_back(to_ns(t_end - result.t_pt1));
+		}
+		phase_ns[4].push_back(to_ns(t_end - t_parsed));
+		phase_ns[5].push_back(to_ns(t_end - t_start));
+	}
 
-		std::sort(num_inspections.begin(), num_inspections.end());
-
-		return (*(num_inspections.end() - 1)) * (*(num_inspections.end() - 2));
-		};
+	for (size_t idx_phase = 0; idx_phase < phases.size(); idx_phase++) {
+		auto& vals = phase_ns[idx_phase];
+		if ((int)vals.size() != options.num_iterations) {
+			continue;
+		}
+		std::sort(vals.begin(), vals.end());
+		rows->push_back({ id, input.name, phases[idx_phase], options.num_iterations, vals[0], percentile(vals, 0.5), percentile(vals, 0.99) });
+	}
 
-	result->pt1 = simulate(monkeys, tot_items, 20, 3);
-	result->pt2 = simulate(monkeys, tot_items, 10000, 1);
+	return true;
 }
 
-void aoc12(std::vector<std::string> lines, Task_result* result) {
-	auto num_rows = lines.size();
-	auto num_cols = lines[0].size();
+// Writes JSON if the file name ends with .json, otherwise CSV
+bool write_bench_results(const std::string& fn, const std::vector<Bench_row>& rows) {
+	std::ofstream outfile(fn);
 
-	std::vector<std::vector<char>> grid(num_rows, std::vector<char>(num_cols));
+	if (!outfile) {
+		std::cout << "Could not open output file " << fn << std::endl;
+		return false;
+	}
 
-	size_t cur_pos_col = 0;
-	size_t cur_pos_row = 0;
-	size_t end_pos_col = 0;
-	size_t end_pos_row = 0;
+	bool use_json = std::filesystem::path(fn).extension() == ".json";
 
-	for (auto idx_row = 0; idx_row < num_rows; idx_row++) {
-		for (auto idx_col = 0; idx_col < num_cols; idx_col++) {
-			auto cur_char = lines[idx_row][idx_col];
-			if (cur_char == 'S') {
-				cur_char = 'a';
-				cur_pos_col = idx_col;
-				cur_pos_row = idx_row;
-			}
-			if (cur_char == 'E') {
-				cur_char = 'z';
-				end_pos_col = idx_col;
-				end_pos_row = idx_row;
-			}
-			grid[idx_row][idx_col] = cur_char;
-		}
-	}
-
-	auto shortest_path = [](std::vector<std::vector<char>>& grid, std::function<bool(int cur_val, int check_val)> cond, size_t start_row, size_t start_col) -> std::vector<std::vector<size_t>> {
-		size_t num_rows = grid.size();
-		size_t num_cols = grid[0].size();
-		std::vector<std::vector<size_t>> num_steps(num_rows, std::vector<size_t>(num_cols, std::numeric_limits<size_t>::max()));
-
-		num_steps[start_row][start_col] = 0;
-		std::vector<int> neighbor_pos_add_x = { -1,0,1,0 };
-		std::vector<int> neighbor_pos_add_y = { 0,-1,0,1 };
-
-		size_t buf_size = 1'000;
-
-		std::vector<std::vector<int>> row_bufs(2, std::vector<int>(buf_size));
-		std::vector<std::vector<int>> col_bufs(2, std::vector<int>(buf_size));
-		std::vector<std::vector<bool>> is_checked(num_rows, std::vector<bool>(num_cols, false));
-		size_t idx_buf = 0;
-		row_bufs[idx_buf][0] = (int)start_row;
-		col_bufs[idx_buf][0] = (int)start_col;
-		size_t num_updates = 1;
-		is_checked[start_row][start_col] = true;
-
-		bool done = false;
-		int max_iter = 10'000;
-
-		while (!done && max_iter-- > 0) {
-			auto prev_num_updates = num_updates;
-			num_updates = 0;
-			auto prev_idx_buf = idx_buf;
-			idx_buf = (idx_buf + 1) % 2;
-			for (auto idx_element = 0; idx_element < prev_num_updates; idx_element++) {
-				auto cur_row = row_bufs[prev_idx_buf][idx_element];
-				auto cur_col = col_bufs[prev_idx_buf][idx_element];
-				auto cur_steps = num_steps[cur_row][cur_col];
-				auto cur_height = grid[cur_row][cur_col];
-				for (size_t idx_neighbor = 0; idx_neighbor < 4; idx_neighbor++) {
-					int check_col = cur_col + neighbor_pos_add_x[idx_neighbor];
-					int check_row = cur_row + neighbor_pos_add_y[idx_neighbor];
-					if (check_col < 0 || check_col >= num_cols) {
-						continue;
-					}
-					if (check_row < 0 || check_row >= num_rows) {
-						continue;
-					}
-					if (num_steps[check_row][check_col] < cur_steps) {
-						continue;
-					}
-					if (is_checked[check_row][check_col]) {
-						continue;
-					}
-					auto check_height = grid[check_row][check_col];
-					if (cond(cur_height, check_height)) {
-						is_checked[check_row][check_col] = true;
-						num_steps[check_row][check_col] = cur_steps + 1;
-						row_bufs[idx_buf][num_updates] = check_row;
-						col_bufs[idx_buf][num_updates] = check_col;
-						num_updates++;
-					}
-				}
-			}
-			if (num_updates == 0) {
-				done = true;
-			}
+	if (use_json) {
+		outfile << "[\n";
+		for (size_t i = 0; i < rows.size(); i++) {
+			auto& row = rows[i];
+			outfile << std::format("  {{\"day\": {}, \"input\": \"{}\", \"phase\": \"{}\", \"iterations\": {}, \"min_ns\": {}, \"median_ns\": {}, \"p99_ns\": {}}}{}\n",
+				row.id, row.input, row.phase, row.num_iterations, row.min_ns, row.median_ns, row.p99_ns, i + 1 < rows.size() ? "," : "");
+		}
+		outfile << "]\n";
+	}
+	if (!use_json) {
+		outfile << "day,input,phase,iterations,min_ns,median_ns,p99_ns\n";
+		for (auto& row : rows) {
+			outfile << std::format("{},{},{},{},{},{},{}\n", row.id, row.input, row.phase, row.num_iterations, row.min_ns, row.median_ns, row.p99_ns);
 		}
+	}
 
-		return num_steps;
-		};
+	return true;
+}
 
-	auto cond = [](int cur_val, int check_val) {
-		return (check_val <= cur_val || (check_val - cur_val) == 1);
-		};
-	auto num_steps = shortest_path(grid, cond, cur_pos_row, cur_pos_col);
-
-	result->pt1 = num_steps[end_pos_row][end_pos_col];
-	
-	std::vector<int> possible_start_row = {};
-	std::vector<int> possible_start_col = {};
-	for (auto idx_row = 0; idx_row < num_rows; idx_row++) {
-		for (auto idx_col = 0; idx_col < num_cols; idx_col++) {
-			auto cur_char = lines[idx_row][idx_col];
-			if (cur_char == 'a') {
-				possible_start_row.push_back(idx_row);
-				possible_start_col.push_back(idx_col);
+bool bench(const Run_options& options) {
+	auto& fns = aoc_fns();
+	std::vector<Bench_row> rows = {};
+	bool ok = true;
+
+	for (auto id : options.ids) {
+		if (fns.count(id) == 0) {
+			std::cout << "Could not find implementation for ID " << id << std::endl;
+			ok = false;
+			continue;
+		}
+		std::vector<Input_source> inputs = {};
+		if (get_inputs(id, options, &inputs)) {
+			for (auto& input : inputs) {
+				ok = bench_with_file(id, input, options, &rows) && ok;
 			}
 		}
+		else {
+			ok = false;
+		}
+		remove_generated_inputs(inputs);
 	}
 
-	int cur_min_steps = std::numeric_limits<int>::max();
-	for (size_t i = 0; i < possible_start_row.size(); i++) {
-		auto start_row = possible_start_row[i];
-		auto start_col = possible_start_col[i];
-		auto this_num_steps = shortest_path(grid, cond, start_row, start_col);
-		auto val = this_num_steps[end_pos_row][end_pos_col];
-		if (val < cur_min_steps) {
-			cur_min_steps = (int)val;
-		}
+	std::cout << std::format("{:>4} {:>12} {:>6} {:>14} {:>14} {:>14}", "day", "input", "phase", "min_ns", "median_ns", "p99_ns") << std::endl;
+	for (auto& row : rows) {
+		std::cout << std::format("{:>4} {:>12} {:>6} {:>14} {:>14} {:>14}", row.id, row.input, row.phase, row.min_ns, row.median_ns, row.p99_ns) << std::endl;
 	}
-	result->pt2 = cur_min_steps;
+
+	if (!options.fn_out.empty()) {
+		ok = write_bench_results(options.fn_out, rows) && ok;
+	}
+
+	return ok;
 }
 
-bool aoc(int id) {
-	std::map<int, std::function<void(std::vector<std::string>, Task_result*)>> fns = {
-		{1,		aoc01},
-		{2,		aoc02},
-		{3,		aoc03},
-		{4,		aoc04},
-		{5,		aoc05},
-		{6,		aoc06},
-		{7,		aoc07},
-		{8,		aoc08},
-		{9,		aoc09},
-		{10,	aoc10},
-		{11,	aoc11},
-		{12,	aoc12},
-		//{13,	aoc13},
-		//{14,	aoc14},
-		//{15,	aoc15},
-		//{16,	aoc16},
-		//{17,	aoc17},
-		//{18,	aoc18},
-		//{19,	aoc19},
-		//{20,	aoc20},
-		//{21,	aoc21},
-		//{22,	aoc22},
-		//{23,	aoc23},
-		//{24,	aoc24},
-		//{25,	aoc25}
-	};
+// Writes a generated input for the first requested day to the output file, or stdout
+bool generate(const Run_options& options) {
+	auto size = options.gen_sizes.empty() ? 1'000 : options.gen_sizes[0];
 
-	if (fns.count(id) == 0) {
-		std::cout << "Could not find implementation for ID " << id << std::endl;
+	if (options.fn_out.empty()) {
+		return generate_input(options.ids[0], size, options.gen_seed, std::cout);
+	}
+
+	std::ofstream outfile(options.fn_out, std::ios::binary);
+
+	if (!outfile) {
+		std::cout << "Could not open output file " << options.fn_out << std::endl;
 		return false;
 	}
 
-	auto run_with_file = [&id, &fns](bool use_test_data) {
-		std::string fn_relative = std::format("aoc{:02}-{}.txt", id, use_test_data ? "test" : "real");
-		std::string fn_absolute = {};
+	return generate_input(options.ids[0], size, options.gen_seed, outfile);
+}
 
-		if (!get_data_file_name(&fn_absolute, fn_relative)) {
-			std::cout << "Could not get data file name" << std::endl;
-			return false;
-		}
+void print_usage() {
+	std::cout << "Usage: aoc2022 [days] [options]\n"
+		"  days                 Day numbers, ranges (1-5) or 'all'. Defaults to the latest day\n"
+		"  --input <which>      test, real or both (default both)\n"
+		"  --file <file>        Use this input file instead of the test and real inputs\n"
+		"  --size <n>           Use a generated input of size n instead. Can be given several times.\n"
+		"                       n is the number of elves, rounds, groups, pairs, moves, characters,\n"
+		"                       directories, grid side, moves, instructions, monkeys or grid side for days 1-12\n"
+		"  --seed <n>           Seed for generated inputs (default 1)\n"
+		"  --generate           Write the generated input for the first day to --out (or stdout) and exit\n"
+		"  --threads <n>        Threads for running days and their inner parallel work, 0 for one per core (default 0)\n"
+		"  --stream             Feed days 1-4, 6, 7, 9 and 10 their input in chunks instead of all at once.\n"
+		"                       Can't be combined with --bench\n"
+		"  --chunk-size <n>     Chunk size in bytes for --stream (default 1048576)\n"
+		"  --bench <n>          Benchmark each day n times and report min/median/p99 per phase\n"
+		"  --warmup <n>         Untimed runs before benchmarking (default 3)\n"
+		"  --out <file>         Write benchmark results (.json for JSON, otherwise CSV) or the generated input" << std::endl;
+}
 
-		auto lines = read_file(fn_absolute);
-		Task_result result = {};
+template <typename T>
+bool parse_int(std::string_view s, T* val) {
+	auto res = std::from_chars(s.data(), s.data() + s.size(), *val);
+
+	return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+bool parse_args(int argc, char* argv[], Run_options* options) {
+	auto& fns = aoc_fns();
+
+	for (int idx_arg = 1; idx_arg < argc; idx_arg++) {
+		std::string_view arg = argv[idx_arg];
+		bool has_value = idx_arg + 1 < argc;
+
+		if (arg == "--input" && has_value) {
+			std::string_view which = argv[++idx_arg];
+			options->use_test_data = which == "test" || which == "both";
+			options->use_real_data = which == "real" || which == "both";
+			if (!options->use_test_data && !options->use_real_data) {
+				std::cout << "Unknown input: " << which << std::endl;
+				return false;
+			}
+			continue;
+		}
+		if (arg == "--file" && has_value) {
+			options->fn_input = argv[++idx_arg];
+			continue;
+		}
+		if (arg == "--size" && has_value) {
+			long long size = 0;
+			if (!parse_int(argv[++idx_arg], &size) || size < 1) {
+				std::cout << "Invalid size: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			options->gen_sizes.push_back(size);
+			continue;
+		}
+		if (arg == "--seed" && has_value) {
+			if (!parse_int(argv[++idx_arg], &options->gen_seed)) {
+				std::cout << "Invalid seed: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			continue;
+		}
+		if (arg == "--generate") {
+			options->generate_only = true;
+			continue;
+		}
+		if (arg == "--threads" && has_value) {
+			int num_threads = 0;
+			if (!parse_int(argv[++idx_arg], &num_threads) || num_threads < 0) {
+				std::cout << "Invalid number of threads: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			options->num_threads = num_threads;
+			continue;
+		}
+		if (arg == "--stream") {
+			options->use_stream = true;
+			continue;
+		}
+		if (arg == "--chunk-size" && has_value) {
+			int chunk_size = 0;
+			if (!parse_int(argv[++idx_arg], &chunk_size) || chunk_size < 1) {
+				std::cout << "Invalid chunk size: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			options->stream_chunk_size = chunk_size;
+			continue;
+		}
+		if (arg == "--bench" && has_value) {
+			if (!parse_int(argv[++idx_arg], &options->num_iterations) || options->num_iterations < 1) {
+				std::cout << "Invalid number of iterations: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			continue;
+		}
+		if (arg == "--warmup" && has_value) {
+			if (!parse_int(argv[++idx_arg], &options->num_warmup) || options->num_warmup < 0) {
+				std::cout << "Invalid number of warmup runs: " << argv[idx_arg] << std::endl;
+				return false;
+			}
+			continue;
+		}
+		if (arg == "--out" && has_value) {
+			options->fn_out = argv[++idx_arg];
+			continue;
+		}
+		if (arg == "all") {
+			for (auto& [id, fn] : fns) {
+				options->ids.push_back(id);
+			}
+			continue;
+		}
 
-		fns[id](lines, &result);
+		int id_first = 0;
+		int id_last = 0;
+		auto idx_dash = arg.find('-');
+		bool valid = false;
 
-		std::string pt1 = std::to_string(result.pt1);
-		std::string pt2 = std::to_string(result.pt2);
-		if (!result.pt1_string.empty()) {
-			pt1 = result.pt1_string;
+		if (idx_dash == std::string_view::npos) {
+			valid = parse_int(arg, &id_first);
+			id_last = id_first;
+		}
+		if (idx_dash != std::string_view::npos && idx_dash > 0) {
+			valid = parse_int(arg.substr(0, idx_dash), &id_first) && parse_int(arg.substr(idx_dash + 1), &id_last);
+		}
+		if (!valid || id_first > id_last) {
+			std::cout << "Unknown argument: " << arg << std::endl;
+			return false;
 		}
-		if (!result.pt2_string.empty()) {
-			pt2 = result.pt2_string;
+		for (int id = id_first; id <= id_last; id++) {
+			options->ids.push_back(id);
 		}
-		std::cout << std::format("AOC-{:02} ({}):\n  pt1: {}\n  pt2: {}", id, use_test_data ? "test" : "real", pt1, pt2) << std::endl;
+	}
 
-		return true;
-		};
+	// Benchmarks time the phases of the regular solvers, which streaming fuses
+	if (options->use_stream && options->num_iterations > 0) {
+		std::cout << "--stream can't be combined with --bench" << std::endl;
+		return false;
+	}
 
-	run_with_file(true);
-	run_with_file(false);
+	if (options->ids.empty() && !fns.empty()) {
+		options->ids.push_back(fns.rbegin()->first);
+	}
 
-	return true;
+	return !options->ids.empty();
 }
 
-int main() {
-	int aoc_id = 12;
+int main(int argc, char* argv[]) {
+	Run_options options = { {}, true, true, {}, {}, 1, false, 0, false, 1 << 20, 0, 3, {} };
+
+	if (!parse_args(argc, argv, &options)) {
+		print_usage();
+		return 1;
+	}
+
+	if (options.generate_only) {
+		return generate(options) ? 0 : 1;
+	}
+
+	thread_budget = options.num_threads;
+
+	if (options.num_iterations > 0) {
+		return bench(options) ? 0 : 1;
+	}
+
 	auto t_start = std::chrono::high_resolution_clock::now();
-	aoc(aoc_id);
+	bool ok = aoc(options);
 	auto t_end = std::chrono::high_resolution_clock::now();
 
 	auto duration = duration_cast<std::chrono::milliseconds>(t_end - t_start);
 	std::cout << "Duration: " << duration.count() << "ms" << std::endl;
 
-	return 0;
+	return ok ? 0 : 1;
 
-}
\ No newline at end of file
+}